@@ -1,21 +1,39 @@
 #include "ServoDriveLS_L7NH.h"
 
-// use namespace for prevent confilict to other sources.
 namespace _L7NH
 {
-    // union structure for save variable in any format.
-    union UNION_DATA
+    // Parameter snapshot file header.
+    struct ParamsFileHeader
     {
-        uint8_t ui8a[100];
-        uint8_t ui8;
-        uint16_t ui16;
-        uint32_t ui32;
-        int8_t i8;
-        int16_t i16;
-        int32_t i32;
-        float f;
-        char s[100];
-    }udata;
+        uint32_t magic;
+        uint16_t version;
+        uint16_t count;
+    };
+
+    // Parameter snapshot file entry.
+    struct ParamsFileEntry
+    {
+        uint16_t index;
+        uint8_t subindex;
+        uint8_t size;
+        uint32_t data;
+    };
+
+    static_assert(sizeof(ParamsFileHeader) == 8, "Parameter snapshot header must be packed.");
+    static_assert(sizeof(ParamsFileEntry) == 8, "Parameter snapshot entry must be packed.");
+
+    // 32 bit FNV-1a hash.
+    static uint32_t paramsFileChecksum(const void *data, size_t size, uint32_t hash = 2166136261u)
+    {
+        const uint8_t *bytes = (const uint8_t *)data;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+
+        return hash;
+    }
 }
 
 using namespace _L7NH;
@@ -28,12 +46,17 @@ L7NH::L7NH()
     parameters.ROTATION_DIR = 0;
     parameters.SPD_UNIT = 0;
     parameters.TORQUE_RATED = 0;
+    parameters.PDO_COMPLETE_ACCESS = 1;
+    parameters.EEPROM_DEADLINE = 5000;
 
     value.runState = 0;
     value.faultState = 0;
     value.limitState = 0;
     value.powerState = 0;
     value.warningState = 0;
+    value.statusWord = 0;
+
+    _lastError.store(ERROR_NONE);
     
     value.controlMode = OPERATION_MODE_NO;
     value.ethercatState = EC_STATE_NONE;
@@ -54,18 +77,52 @@ L7NH::L7NH()
         value.digitalInputs[i] = 0;
     }
 
+    memset(snapshot.raw, 0, sizeof(snapshot.raw));
+    snapshot.size = 0;
+
     _PulsePerRevolution = 0;
     _velConStep2Uu = 1;
+    _completeAccessEnable = true;
+    _sdoWorker = nullptr;
+
+    for(int i = 0; i < L7NH_SDO_STATS_SIZE; i++)
+    {
+        _sdoStats[i].key.store(0, std::memory_order_relaxed);
+        _sdoStats[i].calls.store(0, std::memory_order_relaxed);
+        _sdoStats[i].failures.store(0, std::memory_order_relaxed);
+    }
+
+    _sdoStatsDumpFile.store(nullptr);
+    _sdoStatsDumpPeriod.store(0);
+    _sdoStatsDumpNext.store(0);
 
-    for(int i = 0; i <= (int)sizeof(_TxMapFlag); i++)
+    for(int i = 0; i < L7NH_OBJECT_CACHE_SIZE; i++)
+    {
+        _cache[i].policy = CACHE_POLICY_NONE;
+        _cache[i].valid = false;
+    }
+
+    setObjectCachePolicy(Index_MotorID, 0, CACHE_POLICY_UNTIL_RESET);
+    setObjectCachePolicy(Index_EncoderType, 0, CACHE_POLICY_UNTIL_RESET);
+    setObjectCachePolicy(Index_EncoderPulsePerRevolution, 0, CACHE_POLICY_UNTIL_RESET);
+    setObjectCachePolicy(Index_MotorRatedSpeed, 0, CACHE_POLICY_UNTIL_RESET);
+    setObjectCachePolicy(Index_NodeID, 0, CACHE_POLICY_STATIC);
+    setObjectCachePolicy(Index_SupportedDriveModes, 0, CACHE_POLICY_STATIC);
+
+    RxPDO_rank = 0;
+    TxPDO_rank = 0;
+
+    for(int i = 0; i < (int)sizeof(_TxMapFlag); i++)
     {
         _TxMapFlag[i] = 0;
     }
 
-    for(int i = 0; i <= (int)sizeof(_RxMapFlag); i++)
+    for(int i = 0; i < (int)sizeof(_RxMapFlag); i++)
     {
         _RxMapFlag[i] = 0;
     }
+
+    _unbindPDO();
 }
 
 bool L7NH::init(void)
@@ -77,7 +134,7 @@ bool L7NH::init(void)
 
     if(std::string(ec_slave[parameters.ETHERCAT_ID].name) == "")
     {
-        errorMessage = "Error Servo Driver L7NH: Motor drive can not detected.";
+        _setError(ERROR_DRIVE_NOT_DETECTED);
         return false;
     }
 
@@ -85,7 +142,7 @@ bool L7NH::init(void)
 
     if(_PulsePerRevolution == 0)
     {
-        errorMessage = "Error Servo Driver L7NH: Motor drive getEncoderPulsePerRevolution() was not successed.";
+        _setError(ERROR_ENCODER_PULSE_READ);
         return false;
     }
 
@@ -106,23 +163,14 @@ bool L7NH::init(void)
             _velConStep2Uu = 1.0;
     }
 
-    assignRxPDO_rank(1);
-    assignTxPDO_rank(1);
-
     if(parameters.PDOMAP_CONFIG_TYPE == 1)
     {
-        uint32_t map_rx[2] = {MapValue_ControlWord, MapValue_TargetTorque};
-        uint32_t map_tx[5] = {MapValue_StatusWord, MapValue_PositionActual, MapValue_VelocityActual, MapValue_OperationModeDisplay, MapValue_DigitalInput};
-            
-        if(setRxPDO(sizeof(map_rx)/4, map_rx) == false)
-            return FALSE;
-
-        if(setTxPDO(sizeof(map_tx)/4, map_tx) == false)
+        if(configPDO<PdoLayout_Config1_Rx, PdoLayout_Config1_Tx>() == false)
             return false;
     }
     else
     {
-        errorMessage = "Error Servo Driver L7NH: PDO configuration was not successed.";
+        _setError(ERROR_PDO_CONFIG);
         return false;
     }
  
@@ -136,11 +184,12 @@ bool L7NH::checkParameters(void)
                  (parameters.PDOMAP_CONFIG_TYPE >= 1) &&
                  (parameters.ROTATION_DIR <= 1) &&
                  (parameters.SPD_UNIT <= 1) &&
-                 (parameters.TORQUE_RATED >= 0);
+                 (parameters.TORQUE_RATED >= 0) &&
+                 (parameters.PDO_COMPLETE_ACCESS <= 1);
 
     if(state == false)
     {
-        errorMessage = "Error Servo Driver L7NH: One or some parameters are not correct.";
+        _setError(ERROR_PARAMETERS);
         return false;
     }
 
@@ -179,16 +228,23 @@ bool L7NH::assignRxPDO_rank(int pdo_rank)
         default:
             return FALSE;
     }
+    // Assign PDO index and number of entries by one SDO download if possible.
+    if(_writeCompleteAccess(Index_syncManagerAssignedRxPDO, 1, &index, 2))
+    {
+        RxPDO_rank = pdo_rank;
+        return TRUE;
+    }
+
     // Set subindex 0 to 0 for syncManagerAssignedRxPDO
     data = 0;
-    ec_SDOwrite(parameters.ETHERCAT_ID, Index_syncManagerAssignedRxPDO, 0, FALSE, 1, &data, EC_TIMEOUTRXM);
+    _SDOwrite(Index_syncManagerAssignedRxPDO, 0, FALSE, 1, &data);
 
     // Assign RxPDO index.
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_syncManagerAssignedRxPDO, 1, FALSE, 2, &index, EC_TIMEOUTRXM);
+    wkc = _SDOwrite(Index_syncManagerAssignedRxPDO, 1, FALSE, 2, &index);
 
     // Set subindex 0 to 1 for syncManagerAssignedRxPDO
     data = 1;
-    ec_SDOwrite(parameters.ETHERCAT_ID, Index_syncManagerAssignedRxPDO, 0, FALSE, 1, &data, EC_TIMEOUTRXM);
+    _SDOwrite(Index_syncManagerAssignedRxPDO, 0, FALSE, 1, &data);
 
     if(wkc <= 0)
     {
@@ -228,16 +284,23 @@ bool L7NH::assignTxPDO_rank(int pdo_rank)
         default:
             return FALSE;
     }
+    // Assign PDO index and number of entries by one SDO download if possible.
+    if(_writeCompleteAccess(Index_syncManagerAssignedTxPDO, 1, &index, 2))
+    {
+        TxPDO_rank = pdo_rank;
+        return TRUE;
+    }
+
     // Set subindex 0 to 0 for syncManagerAssignedRxPDO
     data = 0;
-    ec_SDOwrite(parameters.ETHERCAT_ID, Index_syncManagerAssignedTxPDO, 0, FALSE, 1, &data, EC_TIMEOUTRXM);
+    _SDOwrite(Index_syncManagerAssignedTxPDO, 0, FALSE, 1, &data);
 
     // Assign RxPDO index.
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_syncManagerAssignedTxPDO, 1, FALSE, 2, &index, EC_TIMEOUTRXM);
+    wkc = _SDOwrite(Index_syncManagerAssignedTxPDO, 1, FALSE, 2, &index);
 
     // Set subindex 0 to 1 for syncManagerAssignedRxPDO
     data = 1;
-    ec_SDOwrite(parameters.ETHERCAT_ID, Index_syncManagerAssignedTxPDO, 0, FALSE, 1, &data, EC_TIMEOUTRXM);
+    _SDOwrite(Index_syncManagerAssignedTxPDO, 0, FALSE, 1, &data);
 
     if(wkc <= 0)
     {
@@ -253,11 +316,11 @@ uint16_t L7NH::getRxPDOIndex(void)
     int wkc;           
     int size = 2;
     uint16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_syncManagerAssignedRxPDO, 1, FALSE, &size, &data, EC_TIMEOUTRXM);
+    wkc = _SDOread(Index_syncManagerAssignedRxPDO, 1, FALSE, &size, &data);
 
     if(wkc <= 0)
     {
-        errorMessage = "Error Servo driver L7NH: getRxPDOIndex() was not successed.";
+        _setError(ERROR_PDO_INDEX_READ);
         return 0;
     }
         
@@ -269,11 +332,11 @@ uint16_t L7NH::getTxPDOIndex(void)
     int wkc;
     int size = 2;
     uint16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_syncManagerAssignedTxPDO, 1, FALSE, &size, &data, EC_TIMEOUTRXM);
+    wkc = _SDOread(Index_syncManagerAssignedTxPDO, 1, FALSE, &size, &data);
 
     if(wkc <= 0)
     {
-        errorMessage = "Error Servo driver L7NH: getTxPDOIndex() was not successed.";
+        _setError(ERROR_PDO_INDEX_READ);
         return 0;
     }
 
@@ -282,13 +345,6 @@ uint16_t L7NH::getTxPDOIndex(void)
 
 bool L7NH::setRxPDO(uint8_t num_enteries, uint32_t* mapping_entry)
 {
-    _RxMapFlag[0] = 0;
-    _RxMapFlag[1] = 0;
-    _RxMapFlag[2] = 0;
-    _RxMapFlag[3] = 0;
-    _RxMapFlag[4] = 0;
-    _RxMapFlag[5] = 0;
-
     int wkc;
     uint16_t index;
 
@@ -310,22 +366,47 @@ bool L7NH::setRxPDO(uint8_t num_enteries, uint32_t* mapping_entry)
             return FALSE;
     }
 
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, index, 0, FALSE, 1, &num_enteries, EC_TIMEOUTRXM);
+    if(_buildRxMap(num_enteries, mapping_entry) == false)
+        return FALSE;
+
+    // Download whole mapping by one SDO if possible.
+    if(_writeCompleteAccess(index, num_enteries, mapping_entry, 4))
+        return TRUE;
+
+    wkc = _SDOwrite(index, 0, FALSE, 1, &num_enteries);
 
     if(wkc <= 0)
         return FALSE;
 
-    uint8_t offset = 0;
-
     for(int subindex=1; subindex <= num_enteries; subindex++)
     {
-        wkc = ec_SDOwrite(parameters.ETHERCAT_ID, index, subindex, FALSE, 4, &mapping_entry[subindex - 1], EC_TIMEOUTRXM);
+        wkc = _SDOwrite(index, subindex, FALSE, 4, &mapping_entry[subindex - 1]);
         osal_usleep(10000);     // delay 10ms
 
         if(wkc <= 0)
             return FALSE;
+    }
+
+    return TRUE;
+}
+
+bool L7NH::_buildRxMap(uint8_t num_enteries, const uint32_t* mapping_entry)
+{
+    // Offsets change. Old addresses must not be used.
+    _unbindPDO();
+
+    _RxMapFlag[0] = 0;
+    _RxMapFlag[1] = 0;
+    _RxMapFlag[2] = 0;
+    _RxMapFlag[3] = 0;
+    _RxMapFlag[4] = 0;
+    _RxMapFlag[5] = 0;
 
-        switch(mapping_entry[subindex - 1])
+    uint8_t offset = 0;
+
+    for(int i = 0; i < num_enteries; i++)
+    {
+        switch(mapping_entry[i])
         {
             case MapValue_ControlWord:
                 RxMapOffset_ControlWord = offset;
@@ -367,19 +448,6 @@ bool L7NH::setRxPDO(uint8_t num_enteries, uint32_t* mapping_entry)
 
 bool L7NH::setTxPDO(uint8_t num_enteries, uint32_t* mapping_entry)
 {
-    _TxMapFlag[0] = 0;
-    _TxMapFlag[1] = 0;
-    _TxMapFlag[2] = 0;
-    _TxMapFlag[3] = 0;
-    _TxMapFlag[4] = 0;
-    _TxMapFlag[5] = 0;
-    _TxMapFlag[6] = 0;
-    _TxMapFlag[7] = 0;
-    _TxMapFlag[8] = 0;
-    _TxMapFlag[9] = 0;
-    _TxMapFlag[10] = 0;
-    _TxMapFlag[11] = 0;
-
     int wkc;
     uint16_t index;
 
@@ -401,24 +469,55 @@ bool L7NH::setTxPDO(uint8_t num_enteries, uint32_t* mapping_entry)
             return FALSE;
     }
 
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, index, 0, FALSE, 1, &num_enteries, EC_TIMEOUTRXM);
+    if(_buildTxMap(num_enteries, mapping_entry) == false)
+        return FALSE;
+
+    // Download whole mapping by one SDO if possible.
+    if(_writeCompleteAccess(index, num_enteries, mapping_entry, 4))
+        return TRUE;
+
+    wkc = _SDOwrite(index, 0, FALSE, 1, &num_enteries);
 
     if(wkc <= 0)
         return FALSE;
 
-    uint8_t offset = 0;
-
     for(int subindex=1; subindex <= num_enteries; subindex++)
     {
-        wkc = ec_SDOwrite(parameters.ETHERCAT_ID, index, subindex, FALSE, 4, &mapping_entry[subindex - 1], EC_TIMEOUTRXM);
+        wkc = _SDOwrite(index, subindex, FALSE, 4, &mapping_entry[subindex - 1]);
         osal_usleep(10000);   // delay 10ms
 
         if(wkc <= 0)
         {  
             return FALSE;
         }
+    }
+
+    return TRUE;
+}
+
+bool L7NH::_buildTxMap(uint8_t num_enteries, const uint32_t* mapping_entry)
+{
+    // Offsets change. Old addresses must not be used.
+    _unbindPDO();
+
+    _TxMapFlag[0] = 0;
+    _TxMapFlag[1] = 0;
+    _TxMapFlag[2] = 0;
+    _TxMapFlag[3] = 0;
+    _TxMapFlag[4] = 0;
+    _TxMapFlag[5] = 0;
+    _TxMapFlag[6] = 0;
+    _TxMapFlag[7] = 0;
+    _TxMapFlag[8] = 0;
+    _TxMapFlag[9] = 0;
+    _TxMapFlag[10] = 0;
+    _TxMapFlag[11] = 0;
 
-        switch(mapping_entry[subindex - 1])
+    uint8_t offset = 0;
+
+    for(int i = 0; i < num_enteries; i++)
+    {
+        switch(mapping_entry[i])
         {
             case MapValue_StatusWord:
                 TxMapOffset_StatusWord = offset;
@@ -488,297 +587,1136 @@ bool L7NH::setTxPDO(uint8_t num_enteries, uint32_t* mapping_entry)
     return TRUE;
 }
 
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++
-// Save/Restore:
-
-bool L7NH::saveParamsAll(void)
-{
-    int wkc;
-    uint32_t data = SAVE;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_StoreParameters, SubIndex_StoreParametersAll, FALSE, 4, &data, EC_TIMEOUTRXM);
-    
-    osal_usleep(1500000);
-    
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
-}
-
-bool L7NH::saveParamsCommunication(void)
+void L7NH::_unbindPDO(void)
 {
-    int wkc;
-    uint32_t data = SAVE;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_StoreParameters, SubIndex_StoreParametersCommunication, FALSE, 4, &data, EC_TIMEOUTRXM);
-    
-    osal_usleep(1500000);
+    _pdoBound = false;
 
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    for(int i = 0; i < 12; i++)
+    {
+        _txPtr[i] = (const uint8_t *)&_pdoZero;
+    }
 
+    for(int i = 0; i < 6; i++)
+    {
+        _rxPtr[i] = (uint8_t *)&_rxScratch;
+        _rxBound[i] = false;
+    }
 }
 
-bool L7NH::saveParamsCiA402(void)
+bool L7NH::bindPDO(void)
 {
-    int wkc;
-    uint32_t data = SAVE;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_StoreParameters, SubIndex_StoreParametersCiA402, FALSE, 4, &data, EC_TIMEOUTRXM);
-    
-    osal_usleep(1500000);
+    _unbindPDO();
 
-    if(wkc <= 0)
-        return FALSE;
+    if(parameters.ETHERCAT_ID < 1)
+    {
+        _setError(ERROR_PARAMETERS);
+        return false;
+    }
 
-    return TRUE;
-}
+    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
+    uint8 *outputs = ec_slave[parameters.ETHERCAT_ID].outputs;
+    uint32_t inputBytes = (inputs == nullptr) ? 0 : ec_slave[parameters.ETHERCAT_ID].Ibytes;
+    uint32_t outputBytes = (outputs == nullptr) ? 0 : ec_slave[parameters.ETHERCAT_ID].Obytes;
 
-bool L7NH::saveParamsSpecific(void)
-{
-    int wkc;
-    uint32_t data = SAVE;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_StoreParameters, SubIndex_StoreParametersSpecific, FALSE, 4, &data, EC_TIMEOUTRXM);
-    
-    osal_usleep(1500000);
+    const uint8_t txOffset[12] = {TxMapOffset_StatusWord, TxMapOffset_PositionActualInternal, TxMapOffset_PositionActual,
+                                  TxMapOffset_VelocityActual, TxMapOffset_TorqueActual, TxMapOffset_PositionDemandInternal,
+                                  TxMapOffset_PositionDemand, TxMapOffset_VelocityDemand, TxMapOffset_FeedbackSpeed,
+                                  TxMapOffset_TorqueDemand, TxMapOffset_DigitalInput, TxMapOffset_OperationModeDisplay};
+    const uint8_t txSize[12] = {2, 4, 4, 4, 2, 4, 4, 4, 2, 2, 4, 1};
 
-    if(wkc <= 0)
-        return FALSE;
+    const uint8_t rxOffset[6] = {RxMapOffset_ControlWord, RxMapOffset_TargetPosition, RxMapOffset_TargetVelocity,
+                                 RxMapOffset_TargetTorque, RxMapOffset_DigitalOutput_PhysicalOutputs, RxMapOffset_ModesOfOperation};
+    const uint8_t rxSize[6] = {2, 4, 4, 2, 4, 1};
 
-    return TRUE;
-}
+    // Resolve all addresses first. Accessors keep the unbound state if one object does not fit.
+    const uint8_t *txPtr[12];
+    uint8_t *rxPtr[6];
 
-bool L7NH::loadParamsAll(void)
-{
-    int wkc;
-    uint32_t data = LOAD;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_RestoreDefaultParameters, SubIndex_RestoreDefaultParametersAll, FALSE, 4, &data, EC_TIMEOUTRXM);
-    
-    osal_usleep(1500000);
+    for(int i = 0; i < 12; i++)
+    {
+        txPtr[i] = (const uint8_t *)&_pdoZero;
 
-    if(wkc <= 0)
-        return FALSE;
+        if(_TxMapFlag[i] == 0)
+            continue;
 
-    return TRUE;
-}
+        if((uint32_t)txOffset[i] + txSize[i] > inputBytes)
+        {
+            _setError(ERROR_PDO_BIND);
+            return false;
+        }
 
- bool L7NH::loadParamsCommunication(void)
- {
-    int wkc;
-    uint32_t data = LOAD;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_RestoreDefaultParameters, SubIndex_RestoreDefaultParametersCommunication, FALSE, 4, &data, EC_TIMEOUTRXM);
-    
-    osal_usleep(1500000);   
+        txPtr[i] = inputs + txOffset[i];
+    }
 
-    if(wkc <= 0)
-        return FALSE;
+    for(int i = 0; i < 6; i++)
+    {
+        rxPtr[i] = (uint8_t *)&_rxScratch;
 
-    return TRUE;
- }
+        if(_RxMapFlag[i] == 0)
+            continue;
 
-bool L7NH::loadParamsCiA402(void)
-{
-    int wkc;
-    uint32_t data = LOAD;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_RestoreDefaultParameters, SubIndex_RestoreDefaultParametersCiA402, FALSE, 4, &data, EC_TIMEOUTRXM);
-    
-    osal_usleep(1500000);
+        if((uint32_t)rxOffset[i] + rxSize[i] > outputBytes)
+        {
+            _setError(ERROR_PDO_BIND);
+            return false;
+        }
 
-    if(wkc <= 0)
-        return FALSE;
+        rxPtr[i] = outputs + rxOffset[i];
+    }
 
-    return TRUE;
-}
+    for(int i = 0; i < 12; i++)
+    {
+        _txPtr[i] = txPtr[i];
+    }
 
-bool L7NH::loadParamsSpecific(void)
-{
-    int wkc;
-    uint32_t data = LOAD;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_RestoreDefaultParameters, SubIndex_RestoreDefaultParametersSpecific, FALSE, 4, &data, EC_TIMEOUTRXM);
-    
-    osal_usleep(1500000);
+    for(int i = 0; i < 6; i++)
+    {
+        _rxPtr[i] = rxPtr[i];
+        _rxBound[i] = (_RxMapFlag[i] != 0);
+    }
 
-    if(wkc <= 0)
-        return FALSE;
+    _pdoBound = true;
 
-    return TRUE;
+    return true;
 }
-    
-bool L7NH::softwareReset(void)
+
+bool L7NH::_writeCompleteAccess(uint16_t index, uint8_t num_enteries, const void* entries, uint8_t entry_size)
 {
-    ManualJOG_ServoOff();
-    for(int i =1; i<=2; i++)
+    if( (parameters.PDO_COMPLETE_ACCESS == 0) || (_completeAccessEnable == false) )
     {
-        setProcedureCommandCode(ProcedureCommandCode_SoftwareReset);
-        setProcedureCommandArgument(1);
-        osal_usleep(100000);
+        return false;
     }
 
-    return true;
-}
+    // Check the drive announced complete access support in its SII.
+    if( (ec_slave[parameters.ETHERCAT_ID].CoEdetails & ECT_COEDET_SDOCA) == 0 )
+    {
+        _completeAccessEnable = false;
+        return false;
+    }
 
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++
-// Set/Get Driver ID:
+    // Subindex 0 is padded to 16 bit in complete access.
+    uint8_t buffer[2 + 4 * 255];
+    uint16_t count = num_enteries;
+    int size = 2 + num_enteries * entry_size;
 
-bool L7NH::setMotorID(uint16_t ID)
-{
-    int wkc;
+    memcpy(buffer, &count, 2);
+    memcpy(buffer + 2, entries, num_enteries * entry_size);
 
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_MotorID, 0, FALSE, 2, &ID, EC_TIMEOUTRXM);
-    osal_usleep(1000);
+    int wkc = _SDOwrite(index, 0, TRUE, size, buffer);
 
     if(wkc <= 0)
-        return FALSE;
+    {
+        // Do not try complete access again for this drive.
+        _completeAccessEnable = false;
+        return false;
+    }
 
-    return TRUE;
+    return true;
 }
 
-int16_t L7NH::getMotorID(void)
+bool L7NH::_readArrayObject(uint16_t index, uint8_t entry_size, uint8_t max_enteries, uint8_t &num_enteries, void* entries)
 {
     int wkc;
-    int size = 2;
-    uint16_t ID;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_MotorID, 0, FALSE, &size, &ID, EC_TIMEOUTRXM);
-    osal_usleep(1000);
+    int size;
 
-    if(wkc <= 0)
-        return -1;
+    if( (parameters.PDO_COMPLETE_ACCESS != 0) && (_completeAccessEnable == true) &&
+        ((ec_slave[parameters.ETHERCAT_ID].CoEdetails & ECT_COEDET_SDOCA) != 0) )
+    {
+        // Subindex 0 is padded to 16 bit in complete access.
+        uint8_t buffer[2 + 4 * 255];
+        size = 2 + max_enteries * entry_size;
+        wkc = _SDOread(index, 0, TRUE, &size, buffer);
 
-    return (int16_t)ID;
-}
+        if( (wkc > 0) && (size >= 2) && (buffer[0] <= max_enteries) && (size >= 2 + buffer[0] * entry_size) )
+        {
+            num_enteries = buffer[0];
+            memcpy(entries, buffer + 2, num_enteries * entry_size);
+            return true;
+        }
+    }
 
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++
-// Get Driver Node ID:
+    size = 1;
+    wkc = _SDOread(index, 0, FALSE, &size, &num_enteries);
 
-int16_t L7NH::getNodeID(void)
-{
-    int wkc;
-    int size = 2;
-    uint16_t ID;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_NodeID, 0, FALSE, &size, &ID, EC_TIMEOUTRXM);
-    osal_usleep(1000);
+    if( (wkc <= 0) || (num_enteries > max_enteries) )
+        return false;
 
-    if(wkc <= 0)
+    for(int subindex = 1; subindex <= num_enteries; subindex++)
     {
-        errorMessage = "Error L7NH: There is a problem for ethercat connection.";
-        std::cout << errorMessage << std::endl;
-        return -1;
-    } 
+        size = entry_size;
+        wkc = _SDOread(index, subindex, FALSE, &size, (uint8_t*)entries + (subindex - 1) * entry_size);
 
-    return (int16_t)ID;
-}
+        if(wkc <= 0)
+            return false;
+    }
 
-// +++++++++++++++++++++++++++++++++++++++++++++++++++++
-// Set/Get encoder configuration:
+    return true;
+}
 
-bool L7NH::setEncoderType(uint16_t type)
+bool L7NH::_isPDOEqual(uint16_t assign_index, uint16_t map_index, uint8_t num_enteries, const uint32_t* mapping_entry)
 {
-    int wkc;
-    
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_EncoderType, 0, FALSE, 2, &type, EC_TIMEOUTRXM);
-    osal_usleep(1000);
+    uint8_t num;
+    uint16_t assigned[32];
 
-    if(wkc <= 0)
-        return FALSE;
+    if(_readArrayObject(assign_index, 2, 32, num, assigned) == false)
+        return false;
 
-    return TRUE;
-}
+    if( (num != 1) || (assigned[0] != map_index) )
+        return false;
+
+    uint32_t entries[255];
+
+    if(_readArrayObject(map_index, 4, 255, num, entries) == false)
+        return false;
+
+    if(num != num_enteries)
+        return false;
+
+    for(int i = 0; i < num; i++)
+    {
+        if(entries[i] != mapping_entry[i])
+            return false;
+    }
+
+    return true;
+}
+
+bool L7NH::isRxPDOEqual(int pdo_rank, uint8_t num_enteries, const uint32_t* mapping_entry)
+{
+    if( (pdo_rank < 1) || (pdo_rank > 4) )
+        return false;
+
+    return _isPDOEqual(Index_syncManagerAssignedRxPDO, Index_ReceivePDOMapping_1st + pdo_rank - 1, num_enteries, mapping_entry);
+}
+
+bool L7NH::isTxPDOEqual(int pdo_rank, uint8_t num_enteries, const uint32_t* mapping_entry)
+{
+    if( (pdo_rank < 1) || (pdo_rank > 4) )
+        return false;
+
+    return _isPDOEqual(Index_syncManagerAssignedTxPDO, Index_TransmitPDOMapping_1st + pdo_rank - 1, num_enteries, mapping_entry);
+}
+
+bool L7NH::configRxPDO(int pdo_rank, uint8_t num_enteries, uint32_t* mapping_entry)
+{
+    // Warm restart: drive holds the map from the last boot.
+    if(isRxPDOEqual(pdo_rank, num_enteries, mapping_entry))
+    {
+        RxPDO_rank = pdo_rank;
+        return _buildRxMap(num_enteries, mapping_entry);
+    }
+
+    if(assignRxPDO_rank(pdo_rank) == false)
+        return false;
+
+    return setRxPDO(num_enteries, mapping_entry);
+}
+
+bool L7NH::configTxPDO(int pdo_rank, uint8_t num_enteries, uint32_t* mapping_entry)
+{
+    // Warm restart: drive holds the map from the last boot.
+    if(isTxPDOEqual(pdo_rank, num_enteries, mapping_entry))
+    {
+        TxPDO_rank = pdo_rank;
+        return _buildTxMap(num_enteries, mapping_entry);
+    }
+
+    if(assignTxPDO_rank(pdo_rank) == false)
+        return false;
+
+    return setTxPDO(num_enteries, mapping_entry);
+}
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Save/Restore:
+
+bool L7NH::saveParamsAll(void)
+{
+    return _eepromBlocking(Index_StoreParameters, SubIndex_StoreParametersAll, SAVE);
+}
+
+bool L7NH::saveParamsCommunication(void)
+{
+    return _eepromBlocking(Index_StoreParameters, SubIndex_StoreParametersCommunication, SAVE);
+}
+
+bool L7NH::saveParamsCiA402(void)
+{
+    return _eepromBlocking(Index_StoreParameters, SubIndex_StoreParametersCiA402, SAVE);
+}
+
+bool L7NH::saveParamsSpecific(void)
+{
+    return _eepromBlocking(Index_StoreParameters, SubIndex_StoreParametersSpecific, SAVE);
+}
+
+bool L7NH::loadParamsAll(void)
+{
+    return _eepromBlocking(Index_RestoreDefaultParameters, SubIndex_RestoreDefaultParametersAll, LOAD);
+}
+
+bool L7NH::loadParamsCommunication(void)
+{
+    return _eepromBlocking(Index_RestoreDefaultParameters, SubIndex_RestoreDefaultParametersCommunication, LOAD);
+}
+
+bool L7NH::loadParamsCiA402(void)
+{
+    return _eepromBlocking(Index_RestoreDefaultParameters, SubIndex_RestoreDefaultParametersCiA402, LOAD);
+}
+
+bool L7NH::loadParamsSpecific(void)
+{
+    return _eepromBlocking(Index_RestoreDefaultParameters, SubIndex_RestoreDefaultParametersSpecific, LOAD);
+}
+
+bool L7NH::beginSaveParams(uint8_t subindex, EepromHandle &handle)
+{
+    return _beginEeprom(Index_StoreParameters, subindex, SAVE, handle);
+}
+
+bool L7NH::beginLoadParams(uint8_t subindex, EepromHandle &handle)
+{
+    return _beginEeprom(Index_RestoreDefaultParameters, subindex, LOAD, handle);
+}
+
+L7NH::EepromState L7NH::pollParams(EepromHandle &handle)
+{
+    if(handle.state != EEPROM_STATE_BUSY)
+    {
+        return handle.state;
+    }
+
+    // Drive confirms the command after EEPROM write.
+    if(handle.command.ready())
+    {
+        const L7NHSdoResult *result = handle.command.result();
+
+        if(result->wkc > 0)
+        {
+            handle.state = EEPROM_STATE_DONE;
+        }
+        else if(result->latency >= (uint32_t)_eepromTimeout())
+        {
+            // No response in mailbox timeout. Drive may still be writing EEPROM.
+            _setError(ERROR_EEPROM_TIMEOUT);
+            handle.state = EEPROM_STATE_TIMEOUT;
+        }
+        else
+        {
+            _setError(ERROR_EEPROM_COMMAND);
+            handle.state = EEPROM_STATE_FAILED;
+        }
+
+        // Restore rewrites drive objects. Cached values of any policy are old now, or may be.
+        if( (handle.index == Index_RestoreDefaultParameters) && (handle.state != EEPROM_STATE_FAILED) )
+        {
+            clearObjectCache();
+        }
+
+        handle.command.release();
+    }
+    else if(std::chrono::steady_clock::now() >= handle.deadline)
+    {
+        // Only a command that is still queued is withdrawn. A sent one is kept until the worker reports it.
+        if(handle.command.cancel())
+        {
+            _setError(ERROR_EEPROM_DEADLINE);
+            handle.state = EEPROM_STATE_FAILED;
+        }
+    }
+
+    return handle.state;
+}
+
+bool L7NH::waitParams(EepromHandle &handle)
+{
+    while(pollParams(handle) == EEPROM_STATE_BUSY)
+    {
+        osal_usleep(L7NH_EEPROM_POLL_PERIOD);
+    }
+
+    return (handle.state == EEPROM_STATE_DONE);
+}
+
+int L7NH::_eepromTimeout(void)
+{
+    // CiA 301: drive stores the parameters and then confirms the download. So the mailbox timeout of the
+    // command covers the whole EEPROM write, and its response is the completion signal.
+    int64_t timeout = (int64_t)parameters.EEPROM_DEADLINE * 1000;
+
+    if(timeout < EC_TIMEOUTRXM)
+    {
+        timeout = EC_TIMEOUTRXM;
+    }
+    else if(timeout > INT32_MAX)
+    {
+        timeout = INT32_MAX;
+    }
+
+    return (int)timeout;
+}
+
+bool L7NH::_eepromBlocking(uint16_t index, uint8_t subindex, uint32_t command)
+{
+    if( (subindex < 1) || (subindex > 4) )
+    {
+        _setError(ERROR_EEPROM_SUBINDEX);
+        return false;
+    }
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(parameters.EEPROM_DEADLINE);
+
+    bool state = (_SDOwrite(index, subindex, FALSE, 4, &command, _eepromTimeout()) > 0);
+    bool timeout = (state == false) && (std::chrono::steady_clock::now() >= deadline);
+
+    if(timeout)
+        _setError(ERROR_EEPROM_TIMEOUT);
+    else if(state == false)
+        _setError(ERROR_EEPROM_COMMAND);
+
+    // Restore rewrites drive objects. Cached values of any policy are old now, or may be after a timeout.
+    if( (index == Index_RestoreDefaultParameters) && (state || timeout) )
+    {
+        clearObjectCache();
+    }
+
+    return state;
+}
+
+bool L7NH::_beginEeprom(uint16_t index, uint8_t subindex, uint32_t command, EepromHandle &handle)
+{
+    handle.command.release();
+    handle.index = index;
+    handle.subindex = subindex;
+    handle.state = EEPROM_STATE_FAILED;
+
+    if( (subindex < 1) || (subindex > 4) )
+    {
+        _setError(ERROR_EEPROM_SUBINDEX);
+        return false;
+    }
+
+    if(_sdoWorker == nullptr)
+    {
+        _setError(ERROR_SDO_WORKER_NOT_SET);
+        return false;
+    }
+
+    handle.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(parameters.EEPROM_DEADLINE);
+
+    if(_sdoWorker->write(parameters.ETHERCAT_ID, index, subindex, 4, &command, &handle.command,
+                         nullptr, nullptr, &L7NH::_sdoStatObserver, this, _eepromTimeout()) == false)
+    {
+        _setError(ERROR_EEPROM_COMMAND);
+        return false;
+    }
+
+    handle.state = EEPROM_STATE_BUSY;
+
+    return true;
+}
+
+bool L7NH::saveParamsSnapshot(const char *path)
+{
+    ParamsFileHeader header;
+    ParamsFileEntry entries[objTableSize];
+    int count = 0;
+
+    for(int i = 0; i < objTableSize; i++)
+    {
+        const ObjDescriptor &object = objTable[i];
+
+        if(object.persist == false)
+            continue;
+
+        ParamsFileEntry &entry = entries[count];
+        int size = object.size;
+
+        entry.index = object.index;
+        entry.subindex = object.subindex;
+        entry.size = object.size;
+        entry.data = 0;
+
+        if(_SDOread(object.index, object.subindex, FALSE, &size, &entry.data) <= 0)
+        {
+            _setError(ERROR_SNAPSHOT_READ);
+            return false;
+        }
+
+        count++;
+    }
+
+    header.magic = L7NH_PARAMS_FILE_MAGIC;
+    header.version = L7NH_PARAMS_FILE_VERSION;
+    header.count = count;
+
+    uint32_t checksum = paramsFileChecksum(&header, sizeof(header));
+    checksum = paramsFileChecksum(entries, sizeof(ParamsFileEntry) * count, checksum);
+
+    FILE *file = fopen(path, "wb");
+
+    if(file == nullptr)
+    {
+        _setError(ERROR_SNAPSHOT_FILE_OPEN);
+        return false;
+    }
+
+    bool state = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+                 (fwrite(entries, sizeof(ParamsFileEntry), count, file) == (size_t)count) &&
+                 (fwrite(&checksum, sizeof(checksum), 1, file) == 1);
+
+    if( (fclose(file) != 0) || (state == false) )
+    {
+        _setError(ERROR_SNAPSHOT_FILE_WRITE);
+        return false;
+    }
+
+    return true;
+}
+
+bool L7NH::restoreParamsSnapshot(const char *path, int *written)
+{
+    ParamsFileHeader header;
+    ParamsFileEntry entries[objTableSize];
+    uint32_t checksum;
+
+    if(written != nullptr)
+    {
+        *written = 0;
+    }
+
+    FILE *file = fopen(path, "rb");
+
+    if(file == nullptr)
+    {
+        _setError(ERROR_SNAPSHOT_FILE_OPEN);
+        return false;
+    }
+
+    bool state = (fread(&header, sizeof(header), 1, file) == 1) &&
+                 (header.magic == L7NH_PARAMS_FILE_MAGIC) &&
+                 (header.version == L7NH_PARAMS_FILE_VERSION) &&
+                 (header.count <= objTableSize) &&
+                 (fread(entries, sizeof(ParamsFileEntry), header.count, file) == header.count) &&
+                 (fread(&checksum, sizeof(checksum), 1, file) == 1);
+
+    fclose(file);
+
+    if(state == false)
+    {
+        _setError(ERROR_SNAPSHOT_FILE_FORMAT);
+        return false;
+    }
+
+    if(checksum != paramsFileChecksum(entries, sizeof(ParamsFileEntry) * header.count, paramsFileChecksum(&header, sizeof(header))))
+    {
+        _setError(ERROR_SNAPSHOT_FILE_CHECKSUM);
+        return false;
+    }
+
+    // Validate all entries before any write.
+    for(int i = 0; i < header.count; i++)
+    {
+        const ObjDescriptor *object = findObject(entries[i].index, entries[i].subindex);
+
+        if( (object == nullptr) || (object->persist == false) || (object->size != entries[i].size) )
+        {
+            _setError(ERROR_SNAPSHOT_UNKNOWN_PARAMETER);
+            return false;
+        }
+    }
+
+    for(int i = 0; i < header.count; i++)
+    {
+        const ParamsFileEntry &entry = entries[i];
+        uint32_t data = 0;
+        int size = entry.size;
+
+        if( (_SDOread(entry.index, entry.subindex, FALSE, &size, &data) > 0) && (data == entry.data) )
+            continue;
+
+        if(_SDOwrite(entry.index, entry.subindex, FALSE, entry.size, &entry.data) <= 0)
+        {
+            _setError(ERROR_SNAPSHOT_WRITE);
+            state = false;
+            continue;
+        }
+
+        if(written != nullptr)
+        {
+            (*written)++;
+        }
+    }
+
+    // Written objects are invalidated one by one. Objects that depend on them, eg: encoder values of
+    // a new motor ID, may be cached too.
+    clearObjectCache();
+
+    return state;
+}
+
+bool L7NH::softwareReset(void)
+{
+    // Objects cached until reset must be read again.
+    {
+        std::lock_guard<std::mutex> lock(getSdoMutex(parameters.ETHERCAT_ID));
+
+        for(int i = 0; i < L7NH_OBJECT_CACHE_SIZE; i++)
+        {
+            if(_cache[i].policy != CACHE_POLICY_STATIC)
+            {
+                _cache[i].valid = false;
+            }
+        }
+    }
+
+    ManualJOG_ServoOff();
+    for(int i =1; i<=2; i++)
+    {
+        setProcedureCommandCode(ProcedureCommandCode_SoftwareReset);
+        setProcedureCommandArgument(1);
+        osal_usleep(100000);
+    }
+
+    return true;
+}
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Set/Get Driver ID:
+
+bool L7NH::setMotorID(uint16_t ID)
+{
+    bool state = write<Obj::MotorID>(ID);
+    osal_usleep(1000);
+
+    return state;
+}
+
+int16_t L7NH::getMotorID(void)
+{
+    uint16_t ID;
+
+    if(read<Obj::MotorID>(ID) == false)
+        return -1;
+
+    return (int16_t)ID;
+}
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Get Driver Node ID:
+
+int16_t L7NH::getNodeID(void)
+{
+    uint16_t ID;
+
+    if(read<Obj::NodeID>(ID) == false)
+    {
+        _setError(ERROR_ETHERCAT_CONNECTION);
+        return -1;
+    } 
+
+    return (int16_t)ID;
+}
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Set/Get encoder configuration:
+
+bool L7NH::setEncoderType(uint16_t type)
+{
+    bool state = write<Obj::EncoderType>(type);
+    osal_usleep(1000);
+
+    return state;
+}
 
 int16_t L7NH::getEncoderType(void)
+{
+    uint16_t type;
+
+    if(read<Obj::EncoderType>(type) == false)
+        return -1;
+
+    return (int16_t)type;
+}
+
+uint32_t L7NH::getEncoderPulsePerRevolution(void)
+{
+    uint32_t data;
+
+    if(read<Obj::EncoderPulsePerRevolution>(data) == false)
+    {
+        _setError(ERROR_ENCODER_PULSE_READ);
+        return 0;
+    } 
+
+    return data;
+}
+
+uint8_t L7NH::getRotationDirectionSelect(void)
+{
+    uint16_t dir;
+    bool state = read<Obj::RotationDirectionSelect>(dir);
+
+    if(state == false)
+    {
+        _setError(ERROR_ROTATION_DIRECTION_READ);
+        return 2;
+    } 
+
+    return (uint8_t)dir;
+}
+
+bool L7NH::setRotationDirectionSelect(uint16_t dir)
+{
+    if(dir > 1)
+    {
+        _setError(ERROR_ROTATION_DIRECTION_WRITE);
+        return false;
+    }
+    
+    bool state = write<Obj::RotationDirectionSelect>(dir);
+    osal_usleep(1000);
+
+    if(state == false)
+    {
+        _setError(ERROR_ROTATION_DIRECTION_WRITE);
+        return false;
+    }
+
+    return  TRUE;
+}
+
+uint16_t L7NH::getEncoderConfiguration(void)
+{
+    uint16_t data;
+    bool state = read<Obj::EncoderConfiguration>(data);
+
+    if(state == false)
+        return 2;
+
+    return data;
+}
+
+bool L7NH::setEncoderConfiguration(uint16_t config)
+{
+    bool state = write<Obj::EncoderConfiguration>(config);
+    osal_usleep(1000);
+
+    return state;
+}
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Error message:
+
+L7NH::ErrorCode L7NH::getLastError(void)
+{
+    return (ErrorCode)_lastError.load(std::memory_order_relaxed);
+}
+
+void L7NH::clearError(void)
+{
+    _lastError.store(ERROR_NONE, std::memory_order_relaxed);
+}
+
+std::string L7NH::getErrorMessage(void)
+{
+    return std::string(getErrorDescription(getLastError()));
+}
+
+const char* L7NH::getErrorDescription(ErrorCode code)
+{
+    static const char* const descriptions[] =
+    {
+        "No error.",
+        "Error Servo Driver L7NH: Motor drive can not detected.",
+        "Error Servo Driver L7NH: There is a problem for ethercat connection.",
+        "Error Servo Driver L7NH: One or some parameters are not correct.",
+        "Error Servo Driver L7NH: PDO configuration was not successed.",
+        "Error Servo Driver L7NH: Reading of RxPDO/TxPDO index was not successed.",
+        "Error Servo Driver L7NH: Controlword is not in RxPDO mapping.",
+        "Error Servo Driver L7NH: getEncoderPulsePerRevolution() was not successed.",
+        "Error Servo Driver L7NH: getRotationDirectionSelect() was not successed.",
+        "Error Servo Driver L7NH: setRotationDirectionSelect() was not successed.",
+        "Error Servo Driver L7NH: setModesOfOperationSDO() was not successed.",
+        "Error Servo Driver L7NH: EEPROM parameter group subindex is not correct.",
+        "Error Servo Driver L7NH: EEPROM store/restore command was not successed.",
+        "Error Servo Driver L7NH: EEPROM store/restore was not sent before deadline.",
+        "Error Servo Driver L7NH: Parameter snapshot can not read a parameter from drive.",
+        "Error Servo Driver L7NH: Parameter snapshot can not write a parameter to drive.",
+        "Error Servo Driver L7NH: Parameter snapshot file can not be opened.",
+        "Error Servo Driver L7NH: Parameter snapshot file can not be written.",
+        "Error Servo Driver L7NH: Parameter snapshot file format is not correct.",
+        "Error Servo Driver L7NH: Parameter snapshot file checksum is not correct.",
+        "Error Servo Driver L7NH: Parameter snapshot file has an unknown parameter.",
+        "Error Servo Driver L7NH: Object cache is full.",
+        "Error Servo Driver L7NH: SDO worker is not set.",
+        "Error Servo Driver L7NH: PDO object is out of the process image.",
+        "Error Servo Driver L7NH: EEPROM store/restore was sent but not confirmed. Outcome is unknown."
+    };
+
+    static_assert(sizeof(descriptions) / sizeof(descriptions[0]) == ERROR_NUM, "Description table does not match ErrorCode.");
+
+    if( (code < 0) || (code >= ERROR_NUM) )
+    {
+        return "Error Servo Driver L7NH: Unknown error code.";
+    }
+
+    return descriptions[code];
+}
+
+void L7NH::_setError(ErrorCode code)
+{
+    _lastError.store(code, std::memory_order_relaxed);
+
+    L7NHLog::push(parameters.ETHERCAT_ID, code, getErrorDescription(code));
+}
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++
+// SDO access:
+
+int L7NH::_SDOread(uint16_t index, uint8_t subindex, boolean complete_access, int *size, void *data, int timeout)
+{
+    int wkc;
+
+    {
+        std::lock_guard<std::mutex> lock(getSdoMutex(parameters.ETHERCAT_ID));
+
+        if( (complete_access == FALSE) && _cacheGet(index, subindex, data, size) )
+        {
+            return 1;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        wkc = ec_SDOread(parameters.ETHERCAT_ID, index, subindex, complete_access, size, data, timeout);
+
+        _sdoStatRecord(index, subindex, wkc, start);
+
+        if( (wkc > 0) && (complete_access == FALSE) )
+        {
+            _cachePut(index, subindex, data, *size);
+        }
+    }
+
+    return wkc;
+}
+
+int L7NH::_SDOwrite(uint16_t index, uint8_t subindex, boolean complete_access, int size, const void *data, int timeout)
 {
     int wkc;
-    int size = 2;
-    uint16_t type;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_EncoderType, 0, FALSE, &size, &type, EC_TIMEOUTRXM);
-    osal_usleep(1000);
 
-    if(wkc <= 0)
-        return -1;
+    {
+        std::lock_guard<std::mutex> lock(getSdoMutex(parameters.ETHERCAT_ID));
 
-    return (int16_t)type;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        wkc = ec_SDOwrite(parameters.ETHERCAT_ID, index, subindex, complete_access, size, data, timeout);
+
+        _sdoStatRecord(index, subindex, wkc, start);
+
+        // Drive value may be changed even if the response is lost.
+        _CacheEntry *entry = _cacheFind(index, subindex);
+
+        if(entry != nullptr)
+        {
+            entry->valid = false;
+        }
+    }
+
+    return wkc;
 }
 
-uint32_t L7NH::getEncoderPulsePerRevolution(void)
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++
+// SDO statistics:
+
+int L7NH::getSdoStatistics(SdoStatistics *stats, int max_num)
 {
-    int wkc;
-    int size = 4;
-    uint32_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_EncoderPulsePerRevolution, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
-    osal_usleep(1000);
+    int num = 0;
 
-    if(wkc <= 0)
+    for(int i = 0; (i < L7NH_SDO_STATS_SIZE) && (num < max_num); i++)
     {
-        errorMessage = "Error Servo Driver L7NH: getEncoderPulsePerRevolution() was not successed.";
-        std::cout << errorMessage << std::endl;
-        return 0;
-    } 
+        uint32_t key = _sdoStats[i].key.load(std::memory_order_acquire);
 
-    return data;
+        if(key == 0)
+            continue;
+
+        if(getSdoStatistics((uint16_t)(key >> 8), (uint8_t)(key & 0xFF), stats[num]))
+        {
+            num++;
+        }
+    }
+
+    return num;
 }
 
-uint8_t L7NH::getRotationDirectionSelect(void)
+bool L7NH::getSdoStatistics(uint16_t index, uint8_t subindex, SdoStatistics &stats)
 {
-    int wkc;
-    int size = 1;
-    uint8_t dir;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_RotationDirectionSelect, 0, FALSE, &size, &dir, EC_TIMEOUTRXM);
-    osal_usleep(1000);
+    uint32_t key = ((uint32_t)index << 8) | subindex;
+
+    for(int i = 0; i < L7NH_SDO_STATS_SIZE; i++)
+    {
+        _SdoStat &stat = _sdoStats[i];
+
+        if(stat.key.load(std::memory_order_acquire) != key)
+            continue;
+
+        stats.index = index;
+        stats.subindex = subindex;
+        stats.calls = stat.calls.load(std::memory_order_relaxed);
+        stats.failures = stat.failures.load(std::memory_order_relaxed);
+        stats.minUs = stat.latency.min();
+        stats.p50Us = stat.latency.percentile(50);
+        stats.p99Us = stat.latency.percentile(99);
+        stats.maxUs = stat.latency.max();
+
+        return true;
+    }
+
+    return false;
+}
+
+void L7NH::resetSdoStatistics(void)
+{
+    for(int i = 0; i < L7NH_SDO_STATS_SIZE; i++)
+    {
+        _sdoStats[i].calls.store(0, std::memory_order_relaxed);
+        _sdoStats[i].failures.store(0, std::memory_order_relaxed);
+        _sdoStats[i].latency.reset();
+    }
+}
+
+void L7NH::dumpSdoStatistics(FILE *file)
+{
+    SdoStatistics stats[L7NH_SDO_STATS_SIZE];
+    int num = getSdoStatistics(stats, L7NH_SDO_STATS_SIZE);
+
+    fprintf(file, "SDO statistics of slave %d:\n", parameters.ETHERCAT_ID);
+    fprintf(file, "  object         calls  failures   min[us]   p50[us]   p99[us]   max[us]\n");
+
+    for(int i = 0; i < num; i++)
+    {
+        fprintf(file, "  0x%04X:%02X %9u %9u %9u %9u %9u %9u\n", stats[i].index, stats[i].subindex,
+                stats[i].calls, stats[i].failures, stats[i].minUs, stats[i].p50Us, stats[i].p99Us, stats[i].maxUs);
+    }
+
+    fflush(file);
+}
+
+void L7NH::setSdoStatisticsDump(FILE *file, uint32_t period_ms)
+{
+    _sdoStatsDumpPeriod.store(period_ms, std::memory_order_relaxed);
+    _sdoStatsDumpNext.store(0, std::memory_order_relaxed);
+    _sdoStatsDumpFile.store( (period_ms == 0) ? nullptr : file, std::memory_order_release);
+}
+
+void L7NH::_sdoStatRecord(uint16_t index, uint8_t subindex, int wkc, std::chrono::steady_clock::time_point start)
+{
+    uint32_t latency = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    _sdoStatRecord(index, subindex, wkc, latency);
+}
+
+void L7NH::_sdoStatObserver(const L7NHSdoResult &result, void *user)
+{
+    L7NH *driver = (L7NH *)user;
+
+    driver->_sdoStatRecord(result.index, result.subindex, result.wkc, result.latency);
+
+    // Same as _SDOwrite(). Drive value may be changed even if the response is lost.
+    if(result.write)
+    {
+        driver->invalidateObjectCache(result.index, result.subindex);
+    }
+}
+
+void L7NH::_sdoStatRecord(uint16_t index, uint8_t subindex, int wkc, uint32_t latency)
+{
+    uint32_t key = ((uint32_t)index << 8) | subindex;
+    _SdoStat *stat = nullptr;
+
+    for(int i = 0; i < L7NH_SDO_STATS_SIZE; i++)
+    {
+        uint32_t current = _sdoStats[i].key.load(std::memory_order_acquire);
+
+        if(current == key)
+        {
+            stat = &_sdoStats[i];
+            break;
+        }
+
+        // Claim free entry for new object.
+        if( (current == 0) && _sdoStats[i].key.compare_exchange_strong(current, key, std::memory_order_acq_rel) )
+        {
+            stat = &_sdoStats[i];
+            break;
+        }
+
+        if(current == key)
+        {
+            stat = &_sdoStats[i];
+            break;
+        }
+    }
+
+    // Table is full. Object is not tracked.
+    if(stat == nullptr)
+    {
+        return;
+    }
+
+    stat->calls.fetch_add(1, std::memory_order_relaxed);
 
     if(wkc <= 0)
     {
-        errorMessage = "Error Servo Driver L7NH: getRotationDirectionSelect() was not successed.";
-        std::cout << errorMessage << std::endl;
-        return 2;
-    } 
+        stat->failures.fetch_add(1, std::memory_order_relaxed);
+    }
 
-    return dir;
+    stat->latency.record(latency);
 }
 
-bool L7NH::setRotationDirectionSelect(uint16_t dir)
+bool L7NH::pollSdoStatisticsDump(void)
 {
-    if(dir > 1)
+    FILE *file = _sdoStatsDumpFile.load(std::memory_order_acquire);
+
+    if(file == nullptr)
     {
-        errorMessage = "Error Servo Driver L7NH: setRotationDirectionSelect() was not successed.";
         return false;
     }
-    
-    int wkc;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_RotationDirectionSelect, 0, FALSE, 2, &dir, EC_TIMEOUTRXM);
-    osal_usleep(1000);
 
-    if(wkc <= 0)
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t next = _sdoStatsDumpNext.load(std::memory_order_relaxed);
+
+    // Only one thread prints for each period.
+    if( (now < next) || !_sdoStatsDumpNext.compare_exchange_strong(next, now + _sdoStatsDumpPeriod.load(std::memory_order_relaxed), std::memory_order_relaxed) )
     {
-        errorMessage = "Error Servo Driver L7NH: setRotationDirectionSelect() was not successed.";
         return false;
     }
 
-    return  TRUE;
+    dumpSdoStatistics(file);
+
+    return true;
 }
 
-uint16_t L7NH::getEncoderConfiguration(void)
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Object cache:
+
+bool L7NH::setObjectCachePolicy(uint16_t index, uint8_t subindex, CachePolicy policy, uint32_t ttl_ms)
 {
-    int wkc;
-    int size = 2;
-    uint16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_EncoderConfiguration, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
-    osal_usleep(1000);
+    std::lock_guard<std::mutex> lock(getSdoMutex(parameters.ETHERCAT_ID));
 
-    if(wkc <= 0)
-        return 2;
+    _CacheEntry *entry = _cacheFind(index, subindex);
 
-    return data;
+    if(entry == nullptr)
+    {
+        if(policy == CACHE_POLICY_NONE)
+        {
+            return true;
+        }
+
+        // Find free entry.
+        for(int i = 0; i < L7NH_OBJECT_CACHE_SIZE; i++)
+        {
+            if(_cache[i].policy == CACHE_POLICY_NONE)
+            {
+                entry = &_cache[i];
+                break;
+            }
+        }
+
+        if(entry == nullptr)
+        {
+            _setError(ERROR_OBJECT_CACHE_FULL);
+            return false;
+        }
+    }
+
+    entry->index = index;
+    entry->subindex = subindex;
+    entry->policy = policy;
+    entry->ttl = ttl_ms;
+    entry->valid = false;
+
+    return true;
 }
 
-bool L7NH::setEncoderConfiguration(uint16_t config)
+void L7NH::invalidateObjectCache(uint16_t index, uint8_t subindex)
 {
-    int wkc;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_EncoderConfiguration, 0, FALSE, 2, &config, EC_TIMEOUTRXM);
-    osal_usleep(1000);
+    std::lock_guard<std::mutex> lock(getSdoMutex(parameters.ETHERCAT_ID));
 
-    if(wkc <= 0)
-        return FALSE;
+    _CacheEntry *entry = _cacheFind(index, subindex);
 
-    return TRUE;
+    if(entry != nullptr)
+    {
+        entry->valid = false;
+    }
+}
+
+void L7NH::clearObjectCache(void)
+{
+    std::lock_guard<std::mutex> lock(getSdoMutex(parameters.ETHERCAT_ID));
+
+    for(int i = 0; i < L7NH_OBJECT_CACHE_SIZE; i++)
+    {
+        _cache[i].valid = false;
+    }
+}
+
+L7NH::_CacheEntry* L7NH::_cacheFind(uint16_t index, uint8_t subindex)
+{
+    for(int i = 0; i < L7NH_OBJECT_CACHE_SIZE; i++)
+    {
+        if( (_cache[i].policy != CACHE_POLICY_NONE) && (_cache[i].index == index) && (_cache[i].subindex == subindex) )
+        {
+            return &_cache[i];
+        }
+    }
+
+    return nullptr;
+}
+
+bool L7NH::_cacheGet(uint16_t index, uint8_t subindex, void* data, int *size)
+{
+    _CacheEntry *entry = _cacheFind(index, subindex);
+
+    if( (entry == nullptr) || (entry->valid == false) )
+    {
+        return false;
+    }
+
+    if(entry->policy == CACHE_POLICY_TTL)
+    {
+        if(std::chrono::steady_clock::now() - entry->stamp >= std::chrono::milliseconds(entry->ttl))
+        {
+            entry->valid = false;
+            return false;
+        }
+    }
+
+    if(*size > entry->size)
+    {
+        *size = entry->size;
+    }
+
+    memcpy(data, &entry->data, *size);
+
+    return true;
+}
+
+void L7NH::_cachePut(uint16_t index, uint8_t subindex, const void* data, int size)
+{
+    _CacheEntry *entry = _cacheFind(index, subindex);
+
+    if( (entry == nullptr) || (size > 4) )
+    {
+        return;
+    }
+
+    entry->data = 0;
+    memcpy(&entry->data, data, size);
+    entry->size = (uint8_t)size;
+    entry->stamp = std::chrono::steady_clock::now();
+    entry->valid = true;
 }
 
 // +++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -804,6 +1742,12 @@ void L7NH::servoOnPDO(void)
         return;
     }
 
+    // Blocking helper. It may be used before the axis is bound by an executor.
+    if( (_pdoBound == false) && (bindPDO() == false) )
+    {
+        return;
+    }
+
     setControlWordPDO(0x0006);
     ec_send_processdata();
     ec_receive_processdata(EC_TIMEOUTRET);
@@ -847,16 +1791,22 @@ bool L7NH::servoOffPDO(void)
         return false;
     }
 
+    // Blocking helper. It may be used before the axis is bound by an executor.
+    if( (_pdoBound == false) && (bindPDO() == false) )
+    {
+        return false;
+    }
+
     // Send "Ready to Disable Operation" command
     if (setControlWordPDO(0x0007)) 
     {
         ec_send_processdata();
         ec_receive_processdata(EC_TIMEOUTRET);
-        osal_usleep(1000); // Sleep for 10ms
+        osal_usleep(1000); // Sleep for 1ms
     } 
     else 
     {
-        printf("Failed to set control word for Disable Operation.\n");
+        _setError(ERROR_CONTROLWORD_NOT_MAPPED);
         return false;
     }
 
@@ -865,11 +1815,11 @@ bool L7NH::servoOffPDO(void)
     {
         ec_send_processdata();
         ec_receive_processdata(EC_TIMEOUTRET);
-        osal_usleep(1000); // Sleep for 10ms
+        osal_usleep(1000); // Sleep for 1ms
     } 
     else 
     {
-        printf("Failed to set control word for Ready to Switch Off\n");
+        _setError(ERROR_CONTROLWORD_NOT_MAPPED);
         return false;
     }
 
@@ -878,11 +1828,11 @@ bool L7NH::servoOffPDO(void)
     {
         ec_send_processdata();
         ec_receive_processdata(EC_TIMEOUTRET);
-        osal_usleep(1000); // Sleep for 10ms
+        osal_usleep(1000); // Sleep for 1ms
     } 
     else 
     {
-        printf("Failed to set control word for Switch Off\n");
+        _setError(ERROR_CONTROLWORD_NOT_MAPPED);
         return false;
     }
 
@@ -892,54 +1842,53 @@ bool L7NH::servoOffPDO(void)
 // +++++++++++++++++++++++++++++++++++++++++++++++++++++
 // Controlword, statusword, Operation mode and machin state
 
-void L7NH::printStateMachine(void)
+void L7NH::printStateMachine(FILE *file)
 {
     uint16_t statusWord = getStatuseWordSDO();
     stateUpdate(statusWord);
 
     if(value.powerState == true)
     {
-        printf("Servo power state is ON.\n");
+        fprintf(file, "Servo power state is ON.\n");
     }
     else
     {
-        printf("Servo power state is OFF.\n");
+        fprintf(file, "Servo power state is OFF.\n");
     }
 
     if(value.runState == true)
     {
-        printf("Servo run state is ON.\n");
+        fprintf(file, "Servo run state is ON.\n");
     }
     else
     {
-        printf("Servo run state is OFF.\n");
+        fprintf(file, "Servo run state is OFF.\n");
     }
 
     if(value.warningState == true)
     {
-        printf("Warning accured.!\n");
+        fprintf(file, "Warning accured.!\n");
     }
 
     if(value.faultState == true)
     {
-        printf("Fault accured.!\n");
+        fprintf(file, "Fault accured.!\n");
     }
 }
 
 bool L7NH::setModesOfOperationSDO(int8_t mode)
 {
-    int wkc;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_ModesOfOperation, 0, FALSE, 1, &mode, EC_TIMEOUTRXM);
+    bool state = write<Obj::ModesOfOperation>(mode);
     osal_usleep(1000);
 
-    if(wkc <= 0)
+    if(state == false)
     {
-        errorMessage = "Error Servo Driver L7NH: setModesOfOperationSDO() was not successed.";
+        _setError(ERROR_MODES_OF_OPERATION_WRITE);
         return FALSE;
     }
     if(getModeOfOperationSDO() != mode)
     {
-        errorMessage = "Error Servo Driver L7NH: setModesOfOperationSDO() was not successed.";
+        _setError(ERROR_MODES_OF_OPERATION_WRITE);
         return FALSE;
     }
 
@@ -951,12 +1900,9 @@ bool L7NH::setModesOfOperationSDO(int8_t mode)
 
 int8_t L7NH::getModeOfOperationSDO(void)
 {
-    int wkc;
-    int size = 1;
     int8_t mode;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_ModesOfOperation, 0, FALSE, &size, &mode, EC_TIMEOUTRXM);
 
-    if(wkc <= 0)
+    if(read<Obj::ModesOfOperation>(mode) == false)
         return 0;
 
     return mode;
@@ -964,78 +1910,50 @@ int8_t L7NH::getModeOfOperationSDO(void)
 
 bool L7NH::setModesOfOperationPDO(int8_t mode)
 {
-    if(_RxMapFlag[5] == 0)
-        return false;
-
-        // Access the process data outputs for the specified slave
-    uint8 *outputs = ec_slave[parameters.ETHERCAT_ID].outputs;
-    
-    // Write the control word to the specified offset
-    int8_t *ptr = (int8_t *)(outputs + RxMapOffset_ModesOfOperation);
-    *ptr = mode;
+    // Unmapped object points to a scratch word.
+    memcpy(_rxPtr[5], &mode, sizeof(mode));
 
-    return true;
+    return _rxBound[5];
 }
 
-bool L7NH::setControlWordPDO(uint16 control_word) 
+bool L7NH::setControlWordPDO(uint16 control_word)
 {
-    if(_RxMapFlag[0] == 0)
-        return false;
-
-    // Access the process data outputs for the specified slave
-    uint8 *outputs = ec_slave[parameters.ETHERCAT_ID].outputs;
-    
-    // Write the control word to the specified offset
-    uint16 *control_word_ptr = (uint16 *)(outputs + RxMapOffset_ControlWord);
-    *control_word_ptr = control_word;
+    // Unmapped object points to a scratch word.
+    memcpy(_rxPtr[0], &control_word, sizeof(control_word));
 
-    return true;
+    return _rxBound[0];
 }
 
-uint16 L7NH::getStatuseWordPDO(void) 
+uint16 L7NH::getStatuseWordPDO(void)
 {
-    if(_TxMapFlag[0] == 0)
-        return 0;
+    uint16_t data;
 
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Read the status word from the specified offset
-    uint16 *status_word_ptr = (uint16 *)(inputs + TxMapOffset_StatusWord);
-    return *status_word_ptr;
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[0], sizeof(data));
+
+    return data;
 }
 
 int8_t L7NH::getOperationModeDisplayPDO(void)
 {
-    if(_TxMapFlag[11] == 0)
-        return 0;
+    int8_t data;
 
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Read the status word from the specified offset
-    int8 *ptr = (int8 *)(inputs + TxMapOffset_OperationModeDisplay);
-    return *ptr;
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[11], sizeof(data));
+
+    return data;
 }
 
 bool L7NH::setControlWordSDO(uint16 control_word)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_Controlword, 0, FALSE, 1, &control_word, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::Controlword>(control_word);
 }
 
 uint16_t L7NH::getStatuseWordSDO(void)
 {
-    int wkc;
-    int size = 2;
-    uint16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_Statusword, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::Statusword::type data;
 
-    if(wkc <= 0)
+    if(read<Obj::Statusword>(data) == false)
         return 0;
 
     return data;
@@ -1043,6 +1961,7 @@ uint16_t L7NH::getStatuseWordSDO(void)
 
 void L7NH::stateUpdate(uint16_t statusWord) 
 {
+    value.statusWord = statusWord;
     value.powerState = ((statusWord & (1 << 1)) != 0);
     value.runState = ((statusWord & (1 << 2)) != 0);
     value.faultState = ((statusWord & (1 << 3)) == 0);
@@ -1055,37 +1974,22 @@ void L7NH::stateUpdate(uint16_t statusWord)
 
 bool L7NH::setTargetPositionSDO(int32_t position)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_TargetPosition, 0, FALSE, 4, &position, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::TargetPosition>(position);
 }
 
 bool L7NH::setTargetPositionPDO(int32_t position)
 {
-    if(_RxMapFlag[1] == 0)
-        return false;
-
-    // Access the process data outputs for the specified slave
-    uint8 *outputs = ec_slave[parameters.ETHERCAT_ID].outputs;
-    
-    // Write the position to the specified offset
-    int32_t *position_ptr = (int32_t *)(outputs + RxMapOffset_TargetPosition);
-    *position_ptr = position;
+    // Unmapped object points to a scratch word.
+    memcpy(_rxPtr[1], &position, sizeof(position));
 
-    return true;
+    return _rxBound[1];
 }
 
 int32_t L7NH::getPositionActualSDO(void)
 {
-    int wkc;
-    int size = 4;
-    int32_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_PositionActualValue, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::PositionActualValue::type data;
 
-    if(wkc <= 0)
+    if(read<Obj::PositionActualValue>(data) == false)
         return 0;
 
     return data;
@@ -1093,26 +1997,19 @@ int32_t L7NH::getPositionActualSDO(void)
 
 int32_t L7NH::getPositionActualPDO(void)
 {
-    if(_TxMapFlag[2] == 0)
-        return 0;
+    int32_t data;
 
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Read from the specified offset
-    int32_t data = *(int32_t *)(inputs + TxMapOffset_PositionActual);
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[2], sizeof(data));
 
     return data;
 }
 
 int32_t L7NH::getPositionDemandInternalSDO(void)
 {
-    int wkc;
-    int size = 4;
-    int32_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_PositionDemandInternalValue, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::PositionDemandInternalValue::type data;
 
-    if(wkc <= 0)
+    if(read<Obj::PositionDemandInternalValue>(data) == false)
         return 0;
 
     return data;
@@ -1167,7 +2064,7 @@ bool L7NH::setDigitalInput(uint8_t inputChannel, uint8_t assignedValue, uint8_t
 
     uint16_t data = ((uint16_t)activeMode << 15) | ((uint16_t)assignedValue); 
 
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, index, 0, FALSE, 2, &data, EC_TIMEOUTRXM);
+    int wkc = _SDOwrite(index, 0, FALSE, 2, &data);
 
     if(wkc <= 0)
         return false;
@@ -1177,12 +2074,9 @@ bool L7NH::setDigitalInput(uint8_t inputChannel, uint8_t assignedValue, uint8_t
 
 uint8_t L7NH::getDigitalInputValueSDO(void)
 {
-    int wkc;
-    int size = 4;
     uint32_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_DigitalInputs, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
 
-    if(wkc <=0)
+    if(read<Obj::DigitalInputs>(data) == false)
         return 0;
 
     uint8_t value = (uint8_t)((data >> 16) & 0xFF);
@@ -1192,18 +2086,20 @@ uint8_t L7NH::getDigitalInputValueSDO(void)
 
 uint8_t L7NH::getDigitalInputValuePDO(void)
 {
-    if(_TxMapFlag[10] == 0)
-        return 0;
+    uint32_t data;
+
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[10], sizeof(data));
+
+    return (uint8_t)((data >> 16) & 0xFF);
+}
 
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Read from the specified offset
-    uint32_t data = *(uint32_t *)(inputs + TxMapOffset_DigitalInput);
+bool L7NH::setDigitalOutputsPDO(uint32_t outputs)
+{
+    // Unmapped object points to a scratch word.
+    memcpy(_rxPtr[4], &outputs, sizeof(outputs));
 
-    uint8_t value = (uint8_t)((data >> 16) & 0xFF);
-    // std::cout << value << std::endl;
-    return value;
+    return _rxBound[4];
 }
 
 int8_t L7NH::getDigitalInputAssignedValue(uint8_t inputChannel)
@@ -1243,7 +2139,7 @@ int8_t L7NH::getDigitalInputAssignedValue(uint8_t inputChannel)
     int wkc;
     int size = 2;
     uint16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, index, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    wkc = _SDOread(index, 0, FALSE, &size, &data);
 
     if(wkc <=0)
         return -1;
@@ -1290,7 +2186,7 @@ int8_t L7NH::getDigitalInputActiveMode(uint8_t inputChannel)
     int wkc;
     int size = 2;
     uint16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, index, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    wkc = _SDOread(index, 0, FALSE, &size, &data);
 
     if(wkc <=0)
         return -1;
@@ -1305,22 +2201,12 @@ int8_t L7NH::getDigitalInputActiveMode(uint8_t inputChannel)
 
 bool L7NH::setProcedureCommandCode(uint16_t value)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_ProcedureCommandCode, 0, FALSE, 2, &value, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::ProcedureCommandCode>(value);
 }
 
 bool L7NH::setProcedureCommandArgument(uint16_t value)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_ProcedureCommandArgument, 0, FALSE, 2, &value, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::ProcedureCommandArgument>(value);
 }
 
 bool L7NH::ManualJOG_ServoOn(void)
@@ -1383,92 +2269,57 @@ bool L7NH::ManualJOG_Stop(void)
 
 bool L7NH::setMaximumTorqueSDO(uint16_t torque)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_MaximumTorque, 0, FALSE, 2, &torque, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::MaximumTorque>(torque);
 }
 
 bool L7NH::setTorqueSlopeSDO(uint32_t slope)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_TorqueSlope, 0, FALSE, 4, &slope, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::TorqueSlope>(slope);
 }
 
 bool L7NH::setTorqueLimitFunctionSelectSDO(uint16_t value)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_TorqueLimitFunctionSelect, 0, FALSE, 2, &value, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::TorqueLimitFunctionSelect>(value);
 }
 
 bool L7NH::setTargetTorqueSDO(int16_t torque)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_TargetTorque, 0, FALSE, 2, &torque, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::TargetTorque>(torque);
 }
 
 bool L7NH::setTargetTorquePDO(int16_t torque)
 {
-    if(_RxMapFlag[3] == 0)
-        return false;
-
-    // Access the process data outputs for the specified slave
-    uint8 *outputs = ec_slave[parameters.ETHERCAT_ID].outputs;
-    
-    // Write the torque to the specified offset
-    int16_t *torque_ptr = (int16_t *)(outputs + RxMapOffset_TargetTorque);
-    *torque_ptr = torque;
+    // Unmapped object points to a scratch word.
+    memcpy(_rxPtr[3], &torque, sizeof(torque));
 
-    return true;
+    return _rxBound[3];
 }
 
 int16_t L7NH::getTorqueActualPDO(void)
 {
-    if(_TxMapFlag[4] == 0)
-        return 0;
+    int16_t data;
 
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Read from the specified offset
-    int32_t data = *(int32_t *)(inputs + TxMapOffset_TorqueActual);
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[4], sizeof(data));
 
     return data;
 }
 
 int16_t L7NH::getTorqueDemandPDO(void)
 {
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Read from the specified offset
-    int32_t data = *(int32_t *)(inputs + TxMapOffset_TorqueDemand);
+    int16_t data;
+
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[9], sizeof(data));
 
     return data;
 }
 
 int16_t L7NH::getTargetTorqueSDO(void)
 {
-    int wkc;
-    int size = 2;
-    int16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_TargetTorque, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::TargetTorque::type data;
 
-    if(wkc <=0)
+    if(read<Obj::TargetTorque>(data) == false)
         return 0;
 
     return data;
@@ -1476,88 +2327,79 @@ int16_t L7NH::getTargetTorqueSDO(void)
 
 int16_t L7NH::getTorqueActualSDO(void)
 {
-    int wkc;
-    int size = 2;
-    int16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_TorqueActualValue, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::TorqueActualValue::type data;
 
-    if(wkc <=0)
+    if(read<Obj::TorqueActualValue>(data) == false)
         return 0;
 
-    return data; 
+    return data;
 }
 
 int16_t L7NH::getTorqueDemandSDO(void)
 {
-    int wkc;
-    int size = 2;
-    int16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_TorqueDemandValue, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::TorqueDemandValue::type data;
 
-    if(wkc <=0)
+    if(read<Obj::TorqueDemandValue>(data) == false)
         return 0;
 
-    return data; 
+    return data;
 }
 
 // ++++++++++++++++++++++++++++++++++++++++++++++++
 // Get supported modes:
 
-uint32_t L7NH::getSupportedDriveModes(bool show_op)
+uint32_t L7NH::getSupportedDriveModes(bool show_op, FILE *file)
 {
-    int wkc;
-    int size = 4;
     uint32_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_SupportedDriveModes, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
 
-    if(wkc <= 0)
+    if(read<Obj::SupportedDriveModes>(data) == false)
         return 0;
 
     if(show_op)
     {
         if(data & (1 << 0))
         {
-            printf("Profile position mode supported.\n");
+            fprintf(file, "Profile position mode supported.\n");
         }
 
         if(data & (1 << 1))
         {
-            printf("Velocity mode supported.\n");
+            fprintf(file, "Velocity mode supported.\n");
         }
 
         if(data & (1 << 2))
         {
-            printf("Profile velocity mode supported.\n");
+            fprintf(file, "Profile velocity mode supported.\n");
         }
 
         if(data & (1 << 3))
         {
-            printf("Profile torque mode supported.\n");
+            fprintf(file, "Profile torque mode supported.\n");
         }
 
         if(data & (1 << 5))
         {
-            printf("Homing mode supported.\n");
+            fprintf(file, "Homing mode supported.\n");
         }
 
         if(data & (1 << 6))
         {
-            printf("Interpolated Position mode supported.\n");
+            fprintf(file, "Interpolated Position mode supported.\n");
         }
 
         if(data & (1 << 7))
         {
-            printf("Cyclic synchronous position mode supported.\n");
+            fprintf(file, "Cyclic synchronous position mode supported.\n");
         }
 
         if(data & (1 << 8))
         {
-            printf("Cyclic synchronous velocity mode supported.\n");
+            fprintf(file, "Cyclic synchronous velocity mode supported.\n");
         }
 
         if(data & (1 << 9))
         {
-            printf("Cyclic synchronous torque mode supported.\n");
+            fprintf(file, "Cyclic synchronous torque mode supported.\n");
         }
     }
     
@@ -1566,12 +2408,9 @@ uint32_t L7NH::getSupportedDriveModes(bool show_op)
 
 int32_t L7NH::getPositionActualInternalSDO(void)
 {
-    int wkc;
-    int size = 4;
-    int32_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_PositionActualInternalValue, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::PositionActualInternalValue::type data;
 
-    if(wkc <= 0)
+    if(read<Obj::PositionActualInternalValue>(data) == false)
         return 0;
 
     return data;
@@ -1579,11 +2418,10 @@ int32_t L7NH::getPositionActualInternalSDO(void)
 
 int32_t L7NH::getPositionActualInternalPDO(void)
 {
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Write the torque to the specified offset
-    int32_t data = *(int32_t *)(inputs + TxMapOffset_PositionActualInternal);
+    int32_t data;
+
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[1], sizeof(data));
 
     return data;
 }
@@ -1593,12 +2431,9 @@ int32_t L7NH::getPositionActualInternalPDO(void)
 
 int32_t L7NH::getVelocityActualSDO(void)
 {
-    int wkc;
-    int size = 4;
-    int32_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_VelocityActualValue, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::VelocityActualValue::type data;
 
-    if(wkc <= 0)
+    if(read<Obj::VelocityActualValue>(data) == false)
         return 0;
 
     return data;
@@ -1606,12 +2441,9 @@ int32_t L7NH::getVelocityActualSDO(void)
 
 int32_t L7NH::getVelocityDemandSDO(void)
 {
-    int wkc;
-    int size = 4;
-    int32_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_VelocityDemandValue, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::VelocityDemandValue::type data;
 
-    if(wkc <= 0)
+    if(read<Obj::VelocityDemandValue>(data) == false)
         return 0;
 
     return data;
@@ -1619,62 +2451,40 @@ int32_t L7NH::getVelocityDemandSDO(void)
 
 int32_t L7NH::getVelocityActualPDO(void)
 {
-    if(_TxMapFlag[3] == 0)
-        return 0;
+    int32_t data;
 
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Write the torque to the specified offset
-    int32_t data = *(int32_t *)(inputs + TxMapOffset_VelocityActual);
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[3], sizeof(data));
 
     return data;
 }
 
 int32_t L7NH::getVelocityDemandPDO(void)
 {
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Write the torque to the specified offset
-    int32_t data = *(int32_t *)(inputs + TxMapOffset_VelocityDemand);
+    int32_t data;
+
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[7], sizeof(data));
 
     return data;
 }
 
 bool L7NH::setTargetVelocityPDO(int32_t velocity)
 {
-    if(_RxMapFlag[2] == 0)
-        return false;
+    // Unmapped object points to a scratch word.
+    memcpy(_rxPtr[2], &velocity, sizeof(velocity));
 
-    // Access the process data outputs for the specified slave
-    uint8 *outputs = ec_slave[parameters.ETHERCAT_ID].outputs;
-    
-    // Write the torque to the specified offset
-    int32_t *velocity_ptr = (int32_t *)(outputs + RxMapOffset_TargetVelocity);
-    *velocity_ptr = velocity;
-
-    return true;
+    return _rxBound[2];
 }
 
 bool L7NH::setTargetVelocitySDO(int32_t velocity)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_TargetVelocity, 0, FALSE, 4, &velocity, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::TargetVelocity>(velocity);
 }
 
 bool L7NH::setMaxProfileVelocitySDO(uint32_t velocity)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_MaxProfileVelocity, 0, FALSE, 4, &velocity, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;    
+    return write<Obj::MaxProfileVelocity>(velocity);
 }
 
 bool L7NH::setSpeedLimitFunctionSelect(bool state)
@@ -1689,102 +2499,62 @@ bool L7NH::setSpeedLimitFunctionSelect(bool state)
         data = 0;
     }
 
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_SpeedLimitFunctionSelect, 0, FALSE, 2, &data, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;    
+    return write<Obj::SpeedLimitFunctionSelect>(data);
 }
 
 bool L7NH::setSpeedLimitValueAtTorqueControlMode(uint16_t value)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_SpeedLimitValueAtTorqueControlMode, 0, FALSE, 2, &value, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE; 
+    return write<Obj::SpeedLimitValueAtTorqueControlMode>(value);
 }
 
 int16_t L7NH::getFeedbackSpeedSDO(void)
 {
-    int wkc;
-    int size = 2;
-    int16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_FeedbackSpeed, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::FeedbackSpeed::type data;
 
-    if(wkc <= 0)
+    if(read<Obj::FeedbackSpeed>(data) == false)
         return 0;
 
-    return data;    
+    return data;
 }
 
 int16_t L7NH::getFeedbackSpeedPDO(void)
 {
-    if(_TxMapFlag[8] == 0)
-    return false;
+    int16_t data;
 
-    // Access the process data inputs for the specified slave
-    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
-    
-    // Write the torque to the specified offset
-    int32_t data = *(int32_t *)(inputs + TxMapOffset_FeedbackSpeed);
+    // Unmapped object points to a zero word.
+    memcpy(&data, _txPtr[8], sizeof(data));
 
-    return data;   
+    return data;
 }
 
 uint16_t L7NH::getMotorRatedSpeed(void)
 {
-    int wkc;
-    int size = 2;
     uint16_t data;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_MotorRatedSpeed, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
 
-    if(wkc <= 0)
+    if(read<Obj::MotorRatedSpeed>(data) == false)
         return 0;
 
-    return data;    
+    return data;
 }
 
 bool L7NH::setJogOperationSpeed(int16_t value)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_JogOperationSpeed, 0, FALSE, 2, &value, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;  
-
-    return true;
+    return write<Obj::JogOperationSpeed>(value);
 }
 
 bool L7NH::setSpeedCommandAccelerationTime(uint16_t value)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_SpeedCommandAccelerationTime, 0, FALSE, 2, &value, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;  
-
-    return true;
+    return write<Obj::SpeedCommandAccelerationTime>(value);
 }
 
 bool L7NH::setSpeedCommandDecelerationTime(uint16_t value)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_SpeedCommandDecelerationTime, 0, FALSE, 2, &value, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;  
-
-    return true;
+    return write<Obj::SpeedCommandDecelerationTime>(value);
 }
 
 bool L7NH::setSpeedCommandScurveTime(uint16_t value)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_SpeedCommandScurveTime, 0, FALSE, 2, &value, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;  
-
-    return true;
+    return write<Obj::SpeedCommandScurveTime>(value);
 }
 
 bool L7NH::setServoLockFunctionSetting(uint16_t value)
@@ -1794,52 +2564,46 @@ bool L7NH::setServoLockFunctionSetting(uint16_t value)
         return false;
     }
 
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_ServoLockFunctionSetting, 0, FALSE, 2, &value, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;  
-
-    return true;
+    return write<Obj::ServoLockFunctionSetting>(value);
 }
 
 bool L7NH::setProfileAccelerationSDO(int32_t acc)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_ProfileAcceleration, 0, FALSE, 4, &acc, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;    
+    return write<Obj::ProfileAcceleration>(acc);
 }
 
 bool L7NH::setProfileDecelerationSDO(int32 acc)
 {
-    int wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_ProfileDeceleration, 0, FALSE, 4, &acc, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;      
+    return write<Obj::ProfileDeceleration>(acc);
 }
 
 // +++++++++++++++++++++++++++++++++++++++++++++++++++++
 // Homing:
 
-int L7NH::startHoming(void) {
-
+int L7NH::startHoming(void)
+{
     servoOnSDO();
+
+    if(setModesOfOperationSDO(OPERATION_MODE_HM) == false)
+    {
+        return -1;
+    }
+
     // Shutdown the drive first to clear any errors
-    if (setControlWordSDO(0x0006) != 0) {
+    if(setControlWordSDO(0x0006) == false)
+    {
         return -1;
     }
 
     // Switch on the drive and enable operation
-    if (setControlWordSDO(0x000F) != 0) {
+    if(setControlWordSDO(0x000F) == false)
+    {
         return -1;
     }
 
-    // Start the homing process
-    if (setControlWordSDO(0x001F) != 0) { // 0x001F is the command to start homing in CiA 402
+    // Rising edge of bit 4 starts the homing process in CiA 402
+    if(setControlWordSDO(0x001F) == false)
+    {
         return -1;
     }
 
@@ -1848,23 +2612,14 @@ int L7NH::startHoming(void) {
 
 bool L7NH::setHomeOffset(int32_t offset)
 {
-    int wkc;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_HomeOffset, 0, FALSE, 4, &offset, EC_TIMEOUTRXM);
-
-    if(wkc <= 0)
-        return FALSE;
-
-    return TRUE;
+    return write<Obj::HomeOffset>(offset);
 }
 
 int32_t L7NH::getHomeoffset(void)
 {
-    int wkc;
-    int32_t data;
-    int size = 4;
-    wkc = ec_SDOread(parameters.ETHERCAT_ID, Index_HomeOffset, 0, FALSE, &size, &data, EC_TIMEOUTRXM);
+    Obj::HomeOffset::type data;
 
-    if(wkc <= 0)
+    if(read<Obj::HomeOffset>(data) == false)
         return 0;
 
     return data;
@@ -1872,29 +2627,125 @@ int32_t L7NH::getHomeoffset(void)
 
 bool L7NH::setHomingMethod(int8_t method)
 {
-    int wkc;
-    wkc = ec_SDOwrite(parameters.ETHERCAT_ID, Index_HomingMethod, 0, FALSE, 1, &method, EC_TIMEOUTRXM);
+    return write<Obj::HomingMethod>(method);
+}
 
-    if(wkc <= 0)
-        return FALSE;
+// ++++++++++++++++++++++++++++++++++++++++++++++++
+// Asynchronous SDO:
 
-    return TRUE;
+void L7NH::setSdoWorker(L7NHSdoWorker *worker)
+{
+    _sdoWorker = worker;
+}
+
+bool L7NH::readSDOAsync(uint16_t index, uint8_t subindex, int size, L7NHSdoHandle *handle,
+                        L7NHSdoCallback callback, void *user)
+{
+    if(_sdoWorker == nullptr)
+    {
+        _setError(ERROR_SDO_WORKER_NOT_SET);
+        return false;
+    }
+
+    return _sdoWorker->read(parameters.ETHERCAT_ID, index, subindex, size, handle, callback, user, &L7NH::_sdoStatObserver, this);
+}
+
+bool L7NH::writeSDOAsync(uint16_t index, uint8_t subindex, int size, const void *data, L7NHSdoHandle *handle,
+                         L7NHSdoCallback callback, void *user)
+{
+    if(_sdoWorker == nullptr)
+    {
+        _setError(ERROR_SDO_WORKER_NOT_SET);
+        return false;
+    }
+
+    return _sdoWorker->write(parameters.ETHERCAT_ID, index, subindex, size, data, handle, callback, user, &L7NH::_sdoStatObserver, this);
+}
+
+bool L7NH::getTargetTorqueSDOAsync(L7NHSdoHandle *handle, L7NHSdoCallback callback, void *user)
+{
+    return readAsync<Obj::TargetTorque>(handle, callback, user);
+}
+
+bool L7NH::getStatuseWordSDOAsync(L7NHSdoHandle *handle, L7NHSdoCallback callback, void *user)
+{
+    return readAsync<Obj::Statusword>(handle, callback, user);
+}
+
+bool L7NH::getPositionActualSDOAsync(L7NHSdoHandle *handle, L7NHSdoCallback callback, void *user)
+{
+    return readAsync<Obj::PositionActualValue>(handle, callback, user);
 }
 
 // ++++++++++++++++++++++++++++++++++++++++++++++++
 
+bool L7NH::takeSnapshotPDO(void)
+{
+    // Access the process data inputs for the specified slave
+    uint8 *inputs = ec_slave[parameters.ETHERCAT_ID].inputs;
+
+    if(inputs == nullptr)
+    {
+        snapshot.size = 0;
+        return false;
+    }
+
+    uint32_t size = ec_slave[parameters.ETHERCAT_ID].Ibytes;
+
+    if(size > L7NH_SNAPSHOT_MAX_BYTES)
+    {
+        size = L7NH_SNAPSHOT_MAX_BYTES;
+    }
+
+    memcpy(snapshot.raw, inputs, size);
+    snapshot.size = size;
+
+    return true;
+}
+
 bool L7NH::updateValuesPDO(void)
 {
-    value.posActStep = getPositionActualPDO();
-    value.velActStep = getVelocityActualPDO();
-    value.trqActStep = getTorqueActualPDO();
-    uint16_t statusWord = getStatuseWordPDO();
-    value.controlMode = getOperationModeDisplayPDO();
-    uint8_t digitalInputs = getDigitalInputValuePDO();
+    if(takeSnapshotPDO() == false)
+    {
+        return false;
+    }
 
+    const uint8_t *raw = snapshot.raw;
+    uint16_t statusWord = 0;
+    int8_t modeDisplay = 0;
+    uint32_t digitalInputs = 0;
+    int16_t torque = 0;
+
+    value.posActStep = 0;
+    value.velActStep = 0;
+
+    uint32_t size = snapshot.size;
+
+    // A field is decoded only if it is inside the bytes copied in this snapshot.
+    // A mapping larger than L7NH_SNAPSHOT_MAX_BYTES or not refreshed yet leaves the field zero.
+    bool status = (_TxMapFlag[0] != 0) && (TxMapOffset_StatusWord + 2U <= size);
+
+    if(status)
+        memcpy(&statusWord, raw + TxMapOffset_StatusWord, 2);
+    if( (_TxMapFlag[2] != 0) && (TxMapOffset_PositionActual + 4U <= size) )
+        memcpy(&value.posActStep, raw + TxMapOffset_PositionActual, 4);
+    if( (_TxMapFlag[3] != 0) && (TxMapOffset_VelocityActual + 4U <= size) )
+        memcpy(&value.velActStep, raw + TxMapOffset_VelocityActual, 4);
+    if( (_TxMapFlag[4] != 0) && (TxMapOffset_TorqueActual + 2U <= size) )
+        memcpy(&torque, raw + TxMapOffset_TorqueActual, 2);
+    if( (_TxMapFlag[10] != 0) && (TxMapOffset_DigitalInput + 4U <= size) )
+        memcpy(&digitalInputs, raw + TxMapOffset_DigitalInput, 4);
+    if( (_TxMapFlag[11] != 0) && (TxMapOffset_OperationModeDisplay + 1U <= size) )
+        memcpy(&modeDisplay, raw + TxMapOffset_OperationModeDisplay, 1);
+
+    value.trqActStep = torque;
+    value.controlMode = modeDisplay;
+
+    // Physical inputs are at bits 16 to 23 of DigitalInput object.
+    digitalInputs >>= 16;
     for(int i = 0; i <= 7; i++)
     {
-        value.digitalInputs[i] = ( digitalInputs & (1 << i) );
+        value.digitalInputs[i] = (digitalInputs >> i) & 1;
     }
 
     value.posActDeg = ((float)value.posActStep / (float)_PulsePerRevolution) * 360.0;
@@ -1907,7 +2758,7 @@ bool L7NH::updateValuesPDO(void)
         value.velAct /= parameters.GEAR_RATIO;
     }
 
-    if(_TxMapFlag[0] != 0)
+    if(status)
     {
         stateUpdate(statusWord);
     }
@@ -1942,4 +2793,41 @@ bool L7NH::updateValuesSDO(void)
     stateUpdate(statusWord);
 
     return true;
-}
\ No newline at end of file
+}
+
+// ++++++++++++++++++++++++++++++++++++++++++++++++
+// Unit conversion gains:
+
+float L7NH::getPositionGain(void)
+{
+    if(_PulsePerRevolution == 0)
+    {
+        return 0;
+    }
+
+    float gain = 360.0 / (float)_PulsePerRevolution;
+
+    if(parameters.GEAR_RATIO > 0)
+    {
+        gain /= parameters.GEAR_RATIO;
+    }
+
+    return gain;
+}
+
+float L7NH::getVelocityGain(void)
+{
+    float gain = _velConStep2Uu;
+
+    if(parameters.GEAR_RATIO > 0)
+    {
+        gain /= parameters.GEAR_RATIO;
+    }
+
+    return gain;
+}
+
+float L7NH::getTorqueGain(void)
+{
+    return 0.1 * parameters.TORQUE_RATED;
+}
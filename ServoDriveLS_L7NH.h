@@ -2,21 +2,96 @@
 #define L7NH_H
 
 // Header Includes:
-#include <iostream>                 // standard I/O operations
+#include <string>                   // For error message
 #include <chrono>                   // For time managements
 #include <thread>                   // For thread programming
+#include <mutex>                    // For error message lock
+#include <stdio.h>                  // For parameter snapshot file
 #include "ethercat.h"               // SOEM EtherCAT functionality 
 #include "ServoDriveLS_L7NH_objDict.h"           // Object dictionary for L7NH drivers
+#include "ServoDriveLS_L7NH_objTable.h"          // Object descriptor table
+#include "ServoDriveLS_L7NH_pdoLayout.h"         // Compile-time PDO layouts
+#include "ServoDriveLS_L7NH_sdoWorker.h"         // Asynchronous SDO mailbox worker
+#include "ServoDriveLS_L7NH_histogram.h"         // Lock-free latency histogram
+#include "ServoDriveLS_L7NH_log.h"               // Deferred diagnostic log
 
 // ####################################################
+// Macros:
 
+// Maximum bytes of TxPDO that snapshot can hold.
+#define L7NH_SNAPSHOT_MAX_BYTES         64
+
+// Number of objects that object cache can hold.
+#define L7NH_OBJECT_CACHE_SIZE          16
+
+// Period of EEPROM completion polling. [us]
+#define L7NH_EEPROM_POLL_PERIOD         20000
+
+// Number of objects that SDO statistics can track for each driver.
+#define L7NH_SDO_STATS_SIZE             32
+
+// Parameter snapshot file magic number. 'L', '7', 'N', 'S'
+#define L7NH_PARAMS_FILE_MAGIC          0x534E374C
+
+// Parameter snapshot file format version.
+#define L7NH_PARAMS_FILE_VERSION        1
+
+// ####################################################
+
+/**
+ * @brief LS L7NH servo driver over EtherCAT.
+ * @note Thread safety:
+ * @note - Instances share no state. Different axes can be driven from different threads.
+ * @note - PDO accessors (get*PDO(), set*PDO(), takeSnapshotPDO(), updateValuesPDO()) are lock-free and only touch the
+ * process image of this slave. Call them for one instance from one thread, usually the cyclic thread.
+ * servoOnPDO() and servoOffPDO() are not accessors: they exchange their own frames and sleep.
+ * @note - PDO accessors copy bytes through addresses resolved once by bindPDO(). Unbound accessors read zero and
+ * writes are dropped.
+ * @note - SDO accessors (*SDO(), read<>(), write<>(), object cache and configuration functions) are
+ * serialized per slave by _L7NH::getSdoMutex(). They can be called from any thread. The same mutex is
+ * used by L7NHSdoWorker, so blocking and asynchronous requests of one slave never interleave.
+ * @note - Getters do not sleep after their SDO read; the upload response completes the transfer. Setters of
+ * drive parameters keep a 1 ms settle time after the SDO write.
+ * @note - Errors are reported by an error code. getLastError() is lock-free and can be called from any thread.
+ * Each error is also pushed into L7NHLog. PDO accessors never allocate, block or make a system call.
+ * @note - The class prints only from functions that take an output file, eg: printStateMachine(), dumpSdoStatistics().
+ * @note - parameters must not be changed while other threads use the instance.
+ */
 class L7NH
 {
 public:
     
-    /// @brief Last error message accured for object.
-    std::string errorMessage;
-    
+    /// @brief Error codes. Description of each code is given by getErrorDescription().
+    enum ErrorCode
+    {
+        ERROR_NONE = 0,
+        ERROR_DRIVE_NOT_DETECTED,
+        ERROR_ETHERCAT_CONNECTION,
+        ERROR_PARAMETERS,
+        ERROR_PDO_CONFIG,
+        ERROR_PDO_INDEX_READ,
+        ERROR_CONTROLWORD_NOT_MAPPED,
+        ERROR_ENCODER_PULSE_READ,
+        ERROR_ROTATION_DIRECTION_READ,
+        ERROR_ROTATION_DIRECTION_WRITE,
+        ERROR_MODES_OF_OPERATION_WRITE,
+        ERROR_EEPROM_SUBINDEX,
+        ERROR_EEPROM_COMMAND,
+        ERROR_EEPROM_DEADLINE,
+        ERROR_SNAPSHOT_READ,
+        ERROR_SNAPSHOT_WRITE,
+        ERROR_SNAPSHOT_FILE_OPEN,
+        ERROR_SNAPSHOT_FILE_WRITE,
+        ERROR_SNAPSHOT_FILE_FORMAT,
+        ERROR_SNAPSHOT_FILE_CHECKSUM,
+        ERROR_SNAPSHOT_UNKNOWN_PARAMETER,
+        ERROR_OBJECT_CACHE_FULL,
+        ERROR_SDO_WORKER_NOT_SET,
+        ERROR_PDO_BIND,
+        ERROR_EEPROM_TIMEOUT,
+        ERROR_NUM                       ///< Number of error codes.
+    };
+
     /// @brief Parameters structure. 
     struct ParameterStructure
     {
@@ -60,6 +135,8 @@ public:
          * 
          * - TXPDO = {MapValue_StatusWord, MapValue_PositionActual, MapValue_VelocityActual, MapValue_OperationModeDisplay, MapValue_DigitalInput}
          * 
+         * @note Same as _L7NH::PdoLayout_Config1_Rx and _L7NH::PdoLayout_Config1_Tx.
+         * 
          * @note #### Other values  
          * 
          * - Not acceptabled. 
@@ -77,6 +154,23 @@ public:
          * @brief Rated torque. [N.m]. Its depend on manufacture designing.
          *  */ 
         float TORQUE_RATED;
+
+        /**
+         * @brief Use complete access SDO for PDO mapping and assignment objects. 0: disable, 1: enable.
+         * @note - Each of 0x1600/0x1A00/0x1C12/0x1C13 is written by one SDO download.
+         * @note - If the drive does not support or rejects complete access, single entry writes are used.
+         */
+        uint8_t PDO_COMPLETE_ACCESS;
+
+        /**
+         * @brief Deadline of EEPROM store/restore completion. [ms]
+         * @note - saveParams*(), loadParams*() and pollParams() fail if the drive does not confirm the command before it.
+         * @note - It is also the mailbox timeout of the store/restore command, because the drive confirms the
+         * command after EEPROM write.
+         * @note - The SDO download response of 0x1010/0x1011 is used instead of polling their status. The drive
+         * sends it after EEPROM write, so no status read is made after the command.
+         */
+        uint32_t EEPROM_DEADLINE;
     }parameters;
 
     /// @brief Values structure.
@@ -103,9 +197,61 @@ public:
         bool faultState;
         bool warningState;
         bool limitState;
-        bool digitalInputs[8];               ///< Statusword register value.
+        uint16_t statusWord;                ///< Statusword register value.
+        bool digitalInputs[8];              ///< Digital inputs. Index 0 is channel 1.
     }value;
+
+    /**
+     * @brief Snapshot structure. Raw copy of the slave TxPDO bytes in the process image.
+     * @note Decode fields by _L7NH::PdoLayout<...>::read<MapValue_...>(snapshot.raw) or use value structure.
+     */
+    struct alignas(64) SnapshotStructure
+    {
+        uint8_t raw[L7NH_SNAPSHOT_MAX_BYTES];   ///< TxPDO bytes with the same order of TxPDO mapping.
+        uint16_t size;                          ///< Number of valid bytes in raw.
+    }snapshot;
     
+    /// @brief Object cache invalidation policies.
+    enum CachePolicy
+    {
+        CACHE_POLICY_NONE = 0,          ///< Not cached. Always read from drive.
+        CACHE_POLICY_STATIC,            ///< Read once. Cleared by clearObjectCache() or a parameter restore.
+        CACHE_POLICY_UNTIL_RESET,       ///< Read once. Cleared by softwareReset(), clearObjectCache() or a parameter restore.
+        CACHE_POLICY_TTL                ///< Read again after its time to live expired.
+    };
+
+    /// @brief EEPROM store/restore states.
+    enum EepromState
+    {
+        EEPROM_STATE_BUSY = 0,          ///< Command is queued or drive is writing EEPROM.
+        EEPROM_STATE_DONE,              ///< Drive confirmed the command after EEPROM write.
+        EEPROM_STATE_FAILED,            ///< Command was rejected, or deadline expired before it was sent.
+        EEPROM_STATE_TIMEOUT            ///< Command was sent but not confirmed in time. Outcome is unknown.
+    };
+
+    /// @brief Handle of a non-blocking EEPROM store/restore.
+    struct EepromHandle
+    {
+        uint16_t index;                                     ///< Index_StoreParameters or Index_RestoreDefaultParameters.
+        uint8_t subindex;                                   ///< Parameter group subindex.
+        EepromState state;                                  ///< Current state.
+        std::chrono::steady_clock::time_point deadline;     ///< Completion deadline.
+        L7NHSdoHandle command;                              ///< Store/restore command on mailbox worker.
+    };
+
+    /// @brief SDO statistics of one object.
+    struct SdoStatistics
+    {
+        uint16_t index;             ///< Object index.
+        uint8_t subindex;           ///< Object subindex.
+        uint32_t calls;             ///< Number of mailbox transfers. Cache hits are not counted.
+        uint32_t failures;          ///< Number of transfers with working counter <= 0.
+        uint32_t minUs;             ///< Minimum latency. [us]
+        uint32_t p50Us;             ///< Median latency. [us]
+        uint32_t p99Us;             ///< 99th percentile latency. [us]
+        uint32_t maxUs;             ///< Maximum latency. [us]
+    };
+
     /// @brief  Default constructor. Init parameters and values.
     L7NH();
 
@@ -121,6 +267,21 @@ public:
      */
     bool checkParameters(void);
 
+    /// @brief Get last error code. It is lock-free and safe to call from any thread.
+    ErrorCode getLastError(void);
+
+    /// @brief Set last error code to ERROR_NONE.
+    void clearError(void);
+
+    /**
+     * @brief Get last error message. It is safe to call from any thread.
+     * @warning It allocates a string. Use getLastError() in real-time thread.
+     */
+    std::string getErrorMessage(void);
+
+    /// @brief Get static description string of an error code.
+    static const char* getErrorDescription(ErrorCode code);
+
     // +++++++++++++++++++++++++++++++++++++++++++++++++++++
     // Set/Get TX/RX PDO configurations:
 
@@ -180,6 +341,58 @@ public:
      */
     bool setTxPDO(uint8_t num_enteries, uint32_t* mapping_entry);
 
+    /**
+     * @brief Check the drive already holds certain RxPDO rank assignment and mapping entries.
+     * @return true if assignment and entries in drive are same as requested.
+     */
+    bool isRxPDOEqual(int pdo_rank, uint8_t num_enteries, const uint32_t* mapping_entry);
+
+    /**
+     * @brief Check the drive already holds certain TxPDO rank assignment and mapping entries.
+     * @return true if assignment and entries in drive are same as requested.
+     */
+    bool isTxPDOEqual(int pdo_rank, uint8_t num_enteries, const uint32_t* mapping_entry);
+
+    /**
+     * @brief Assign RxPDO rank and set its mapping entries.
+     * If the drive already holds the same map, nothing is written and only offsets are updated.
+     * @return true if successed.
+     * @note - slave must in PRE_OP.
+     * @note - Use this function before ethercat configMap().
+     */
+    bool configRxPDO(int pdo_rank, uint8_t num_enteries, uint32_t* mapping_entry);
+
+    /**
+     * @brief Assign TxPDO rank and set its mapping entries.
+     * If the drive already holds the same map, nothing is written and only offsets are updated.
+     * @return true if successed.
+     * @note - slave must in PRE_OP.
+     * @note - Use this function before ethercat configMap().
+     */
+    bool configTxPDO(int pdo_rank, uint8_t num_enteries, uint32_t* mapping_entry);
+
+    /**
+     * @brief Assign rank 1 RxPDO/TxPDO and set them by compile-time layouts.
+     * If the drive already holds the same maps, nothing is written.
+     * @return true if successed.
+     * @note - RxLayout and TxLayout are _L7NH::PdoLayout<...> types.
+     * @note - Use _L7NH::PdoImage<RxLayout, TxLayout> after ethercat configMap() for typed access, or bindPDO() for get*PDO()/set*PDO().
+     * @note - slave must in PRE_OP.
+     * @note - Use this function before ethercat configMap().
+     */
+    template<class RxLayout, class TxLayout>
+    bool configPDO(void);
+
+    /**
+     * @brief Bind PDO accessors to the process image of this slave.
+     * Address of each mapped object is resolved once, so get*PDO()/set*PDO() only copy bytes.
+     * @return true if successed. false if one mapped object is out of the slave process image.
+     * @note - Use this function after ethercat configMap(). L7NHExecutor::start() calls it for its axes.
+     * @note - Before binding, get*PDO() return 0 and set*PDO() return false.
+     * @note - Call it again after setRxPDO()/setTxPDO() or a new configMap().
+     */
+    bool bindPDO(void);
+
     // +++++++++++++++++++++++++++++++++++++++++++++++++++++
     // Set/Get Driver ID:
 
@@ -296,43 +509,133 @@ public:
     // Save/Restore:
 
     // Save all parameters in EEPROM memory.
+    // Wait until drive confirms the command after EEPROM write or EEPROM_DEADLINE expired.
     // retutn: true if successed.
     bool saveParamsAll(void);
 
     // Save Communication parameters in EEPROM memory.
+    // Wait until drive confirms the command after EEPROM write or EEPROM_DEADLINE expired.
     // retutn: true if successed.
     bool saveParamsCommunication(void);
 
     // Save CiA402 parameters in EEPROM memory.
+    // Wait until drive confirms the command after EEPROM write or EEPROM_DEADLINE expired.
     // retutn: true if successed.
     bool saveParamsCiA402(void);
 
     // Save Specific parameters in EEPROM memory.
+    // Wait until drive confirms the command after EEPROM write or EEPROM_DEADLINE expired.
     // retutn: true if successed.
     bool saveParamsSpecific(void);
 
     // Restore and load all default parameters.
+    // Wait until drive confirms the command after EEPROM write or EEPROM_DEADLINE expired.
     // retutn: true if successed.
     bool loadParamsAll(void);
 
     // Restore and load Communication default parameters.
+    // Wait until drive confirms the command after EEPROM write or EEPROM_DEADLINE expired.
     // retutn: true if successed.
     bool loadParamsCommunication(void);
 
     // Restore and load CiA402 default parameters.
+    // Wait until drive confirms the command after EEPROM write or EEPROM_DEADLINE expired.
     // retutn: true if successed.
     bool loadParamsCiA402(void);
 
     // Restore and load Specific default parameters.
+    // Wait until drive confirms the command after EEPROM write or EEPROM_DEADLINE expired.
     // retutn: true if successed.
     bool loadParamsSpecific(void);
 
+    /**
+     * @brief Queue store command of a parameter group on mailbox worker. It never blocks.
+     * @param subindex is SubIndex_StoreParameters... macro. 1 to 4.
+     * @param handle is updated for pollParams().
+     * @return true if store command is queued.
+     * @note It needs setSdoWorker(). The worker is busy with the command for the whole EEPROM write,
+     * so give drives their own workers to write their EEPROM at the same time.
+     */
+    bool beginSaveParams(uint8_t subindex, EepromHandle &handle);
+
+    /**
+     * @brief Queue restore command of a parameter group on mailbox worker. It never blocks.
+     * @param subindex is SubIndex_RestoreDefaultParameters... macro. 1 to 4.
+     * @param handle is updated for pollParams().
+     * @return true if restore command is queued.
+     * @note It needs setSdoWorker() like beginSaveParams().
+     */
+    bool beginLoadParams(uint8_t subindex, EepromHandle &handle);
+
+    /**
+     * @brief Check completion of a started store/restore once. It never blocks.
+     * Completion is the SDO download response of the command, which the drive sends after EEPROM write.
+     * It substitutes for polling the status of 0x1010/0x1011.
+     * @return state of handle.
+     * @note - EEPROM_STATE_FAILED if the command was rejected, or EEPROM_DEADLINE expired while it was still queued.
+     * Then the command is withdrawn and never sent.
+     * @note - A command already sent is not abandoned at the deadline. The handle stays BUSY until the worker
+     * reports the response or the mailbox timeout, which is also EEPROM_DEADLINE.
+     * @note - EEPROM_STATE_TIMEOUT if no response came. The drive may still apply the command, so a restore
+     * clears the object cache in this case too.
+     */
+    EepromState pollParams(EepromHandle &handle);
+
+    /**
+     * @brief Poll a started store/restore until pollParams() leaves EEPROM_STATE_BUSY.
+     * @return true if drive reported completion.
+     */
+    bool waitParams(EepromHandle &handle);
+
+    /**
+     * @brief Read all configuration parameters of drive and save them in a binary snapshot file.
+     * Configuration parameters are objects with Persist flag in L7NH_OBJECT_TABLE.
+     * @return true if successed.
+     * @note File format (little-endian):
+     * @note - Header: uint32 magic (L7NH_PARAMS_FILE_MAGIC), uint16 version, uint16 number of entries.
+     * @note - Entries: uint16 index, uint8 subindex, uint8 size, uint32 value. 8 bytes each.
+     * @note - Footer: uint32 FNV-1a checksum of header and entries.
+     */
+    bool saveParamsSnapshot(const char *path);
+
+    /**
+     * @brief Restore configuration parameters from a snapshot file made by saveParamsSnapshot().
+     * Each parameter is read from drive first and only different parameters are written.
+     * @param written is optional output. Number of parameters written to drive.
+     * @return true if successed.
+     * @note Whole file is validated before any write. Object cache is cleared after the writes.
+     * @note Restored values are not saved in EEPROM. Use saveParamsAll() for that.
+     */
+    bool restoreParamsSnapshot(const char *path, int *written = nullptr);
+
     /**
      * @brief Reset software reset of driver by procedure commands.
      * @return true if successed.
      */
     bool softwareReset(void);
 
+    // +++++++++++++++++++++++++++++++++++++++++++++++++++++
+    // Object cache:
+
+    /**
+     * @brief Set cache policy of an object. Object size must be 4 bytes or less.
+     * @param ttl_ms is time to live for CACHE_POLICY_TTL. [ms]
+     * @return true if successed. false if cache is full.
+     * @note Default cached objects: MotorID, EncoderType, EncoderPulsePerRevolution and MotorRatedSpeed are
+     * CACHE_POLICY_UNTIL_RESET. NodeID and SupportedDriveModes are CACHE_POLICY_STATIC.
+     */
+    bool setObjectCachePolicy(uint16_t index, uint8_t subindex, CachePolicy policy, uint32_t ttl_ms = 0);
+
+    /**
+     * @brief Invalidate cached value of an object. Next read comes from drive.
+     */
+    void invalidateObjectCache(uint16_t index, uint8_t subindex);
+
+    /**
+     * @brief Invalidate cached values of all objects.
+     */
+    void clearObjectCache(void);
+
     // +++++++++++++++++++++++++++++++++++++++++++++++++++++
     // Servo ON/OFF:
 
@@ -345,6 +648,8 @@ public:
     // Driver must be in ethercat operational state.
     // After servo On, the proccess data must send cyclic frequently, otherwise driver automaticly set servo Off.
     // Note: just use it if controlword exist in RxPDO mapping.
+    // Warning: It is a blocking helper for applications without a cyclic loop. It sends its own frames and sleeps 30 ms.
+    // In a cyclic application use L7NHStateMachine.
     void servoOnPDO(void);
 
     // Servo Off command.
@@ -353,13 +658,16 @@ public:
 
     // Servo Off command.   
     // Driver must be in ethercat operational state.
+    // Warning: It is a blocking helper for applications without a cyclic loop. It sends its own frames and sleeps 3 ms.
+    // In a cyclic application use L7NHStateMachine.
     bool servoOffPDO(void);
 
     // +++++++++++++++++++++++++++++++++++++++++++++++++++++
     // Controlword, statusword, Operation mode and machin state
     
-    // Get statusword and update sate machine, then Print stateMachine string mode.  
-    void printStateMachine(void);
+    // Get statusword by SDO and update sate machine, then Print stateMachine string mode in file.
+    // Do not use it in real-time thread.
+    void printStateMachine(FILE *file = stdout);
 
     // Set operational mode. eg: PP:1, PV:3, PT:4, CSP:8, CSV:9, CST:10, HOME:6
     // return: true if successed.
@@ -395,12 +703,17 @@ public:
     void stateUpdate(uint16_t statusWord);
 
     // Get and displays the mode(s) supported by the drive.
-    // if show_op be TRUE, print and display modes.
-    uint32_t getSupportedDriveModes(bool show_op);
+    // if show_op be TRUE, print modes in file.
+    uint32_t getSupportedDriveModes(bool show_op, FILE *file = stdout);
 
     // +++++++++++++++++++++++++++++++++++++++++++++++++++++
     // Homing:
 
+    /**
+     * @brief Start homing in SDO mode. Servo is turned on, HM mode is selected and controlword bit 4 is set.
+     * @return 0 if successed, -1 if a step failed.
+     * @note It blocks on SDO and does not wait for completion. Use L7NHHoming for homing from process data.
+     */
     int startHoming(void);
 
     bool setHomeOffset(int32_t offset);
@@ -666,6 +979,13 @@ public:
      */
     uint8_t getDigitalInputValuePDO(void);
 
+    /**
+     * @brief Set digital outputs physical outputs object in PDO mode.
+     * @return true if successed.
+     * @warning Use it when DigitalOutput_PhysicalOutputs exist in PDO mapping.
+     */
+    bool setDigitalOutputsPDO(uint32_t outputs);
+
     /**
      * @brief Read and get digital input assigned value for certain channel.
      * @param inputChannel is channel number of input IO. It can be at range 1 to 8. 
@@ -730,11 +1050,142 @@ public:
      */
     bool ManualJOG_Stop(void);
 
+    // ++++++++++++++++++++++++++++++++++++++++++++++++
+    // Generic object access:
+
+    /**
+     * @brief Read an object by SDO upload.
+     * @param data is output value. Its type must be same as Object::type.
+     * @return true if successed.
+     * @note Object is a _L7NH::Obj type. eg: read<_L7NH::Obj::Statusword>(status)
+     * @note Cached objects are returned from object cache.
+     */
+    template<class Object>
+    bool read(typename Object::type &data);
+
+    /**
+     * @brief Write an object by SDO download.
+     * @return true if successed.
+     * @note Object is a _L7NH::Obj type. eg: write<_L7NH::Obj::Controlword>(0x0006)
+     * @note Cached value of object is invalidated.
+     */
+    template<class Object>
+    bool write(typename Object::type data);
+
+    /**
+     * @brief Queue reading of an object on mailbox worker. It never blocks.
+     * @note Result type is Object::type. eg: handle.result()->as<_L7NH::Obj::Statusword::type>()
+     */
+    template<class Object>
+    bool readAsync(L7NHSdoHandle *handle, L7NHSdoCallback callback = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Queue writing of an object on mailbox worker. It never blocks.
+     * @note Cached value of object is invalidated when the worker served the request.
+     */
+    template<class Object>
+    bool writeAsync(typename Object::type data, L7NHSdoHandle *handle, L7NHSdoCallback callback = nullptr, void *user = nullptr);
+
+    // ++++++++++++++++++++++++++++++++++++++++++++++++
+    // SDO statistics:
+
+    /**
+     * @brief Get statistics of all objects accessed by SDO transfers.
+     * Blocking transfers and requests of this driver served by L7NHSdoWorker are both recorded.
+     * Requests queued on a worker directly by L7NHSdoWorker::read()/write() are not.
+     * @param stats is output array.
+     * @param max_num is capacity of stats array.
+     * @return number of objects written to stats.
+     * @note It is lock-free and can be called from any thread.
+     */
+    int getSdoStatistics(SdoStatistics *stats, int max_num);
+
+    /**
+     * @brief Get statistics of one object.
+     * @return false if object is not accessed yet.
+     */
+    bool getSdoStatistics(uint16_t index, uint8_t subindex, SdoStatistics &stats);
+
+    /// @brief Clear statistics of all objects.
+    void resetSdoStatistics(void);
+
+    /// @brief Print statistics table of all objects in file. eg: dumpSdoStatistics(stdout)
+    void dumpSdoStatistics(FILE *file);
+
+    /**
+     * @brief Enable periodic dump of SDO statistics. The table is printed only by pollSdoStatisticsDump().
+     * @param file is output file. nullptr or period 0 disables periodic dump.
+     * @param period_ms is dump period. [ms]
+     */
+    void setSdoStatisticsDump(FILE *file, uint32_t period_ms);
+
+    /**
+     * @brief Print statistics table if periodic dump is enabled and its period is expired.
+     * @return true if the table is printed.
+     * @note Call it from a non real-time thread, eg: the main loop. SDO transfers only update counters.
+     */
+    bool pollSdoStatisticsDump(void);
+
+    // ++++++++++++++++++++++++++++++++++++++++++++++++
+    // Asynchronous SDO:
+
+    /**
+     * @brief Set mailbox worker for asynchronous SDO requests of this driver.
+     * @note One worker can serve many drivers. nullptr disables asynchronous requests.
+     */
+    void setSdoWorker(L7NHSdoWorker *worker);
+
+    /**
+     * @brief Queue an SDO upload on mailbox worker. It never blocks.
+     * @param handle is optional. Check handle->ready() and handle->result() later.
+     * @param callback is optional completion callback. It runs on mailbox thread.
+     * @return true if request queued.
+     */
+    bool readSDOAsync(uint16_t index, uint8_t subindex, int size, L7NHSdoHandle *handle,
+                      L7NHSdoCallback callback = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Queue an SDO download on mailbox worker. It never blocks.
+     * @param handle is optional. Check handle->ready() and handle->success() later.
+     * @param callback is optional completion callback. It runs on mailbox thread.
+     * @return true if request queued.
+     * @note Cached value of object is invalidated before the handle becomes ready and before callback.
+     */
+    bool writeSDOAsync(uint16_t index, uint8_t subindex, int size, const void *data, L7NHSdoHandle *handle,
+                       L7NHSdoCallback callback = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Queue reading of Target Torque. [0.1%]
+     * @note Result type is int16_t. eg: handle.result()->as<int16_t>()
+     */
+    bool getTargetTorqueSDOAsync(L7NHSdoHandle *handle, L7NHSdoCallback callback = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Queue reading of statusword.
+     * @note Result type is uint16_t. eg: handle.result()->as<uint16_t>()
+     */
+    bool getStatuseWordSDOAsync(L7NHSdoHandle *handle, L7NHSdoCallback callback = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Queue reading of Position Actual Value. [pulses]
+     * @note Result type is int32_t. eg: handle.result()->as<int32_t>()
+     */
+    bool getPositionActualSDOAsync(L7NHSdoHandle *handle, L7NHSdoCallback callback = nullptr, void *user = nullptr);
+
     // ++++++++++++++++++++++++++++++++++++++++++++++++
     // Auto update driver states:
 
+    /**
+     * @brief Copy the slave TxPDO bytes from process image into snapshot by one memcpy.
+     * @return true if successed. false if process image is not mapped.
+     */
+    bool takeSnapshotPDO(void);
+
     /**
      * @brief Update driver values in PDO mode.
+     * Take a snapshot and decode all mapped fields from it in one pass.
+     * @return true if successed.
+     * @note A mapped field that is not inside snapshot.size bytes is not decoded and reads zero.
      */
     bool updateValuesPDO(void);
 
@@ -743,8 +1194,32 @@ public:
      */
     bool updateValuesSDO(void);
 
+    // ++++++++++++++++++++++++++++++++++++++++++++++++
+    // Unit conversion gains:
+
+    /**
+     * @brief Get gain for convert position step unit to user unit. [deg/pulse]
+     * @note GEAR_RATIO is applied. Valid after init().
+     */
+    float getPositionGain(void);
+
+    /**
+     * @brief Get gain for convert velocity step unit to user unit. [SPD_UNIT/(pulse/s)]
+     * @note GEAR_RATIO is applied. Valid after init().
+     */
+    float getVelocityGain(void);
+
+    /**
+     * @brief Get gain for convert torque step unit to user unit. [TORQUE_RATED unit/0.1%]
+     */
+    float getTorqueGain(void);
+
 private:
 
+    friend class L7NHGroup;
+    friend class L7NHStateMachine;
+    friend class L7NHHoming;
+
     // speed conversion gain for convert step unit to user unit.
     float _velConStep2Uu;
 
@@ -793,6 +1268,46 @@ private:
     uint8_t TxMapOffset_DigitalInput;
     uint8_t TxMapOffset_OperationModeDisplay;
 
+    /// Object cache entry.
+    struct _CacheEntry
+    {
+        uint16_t index;
+        uint8_t subindex;
+        uint8_t policy;
+        bool valid;
+        uint8_t size;               ///< Bytes of data. Valid only if valid is true.
+        uint32_t data;
+        uint32_t ttl;
+        std::chrono::steady_clock::time_point stamp;
+    }_cache[L7NH_OBJECT_CACHE_SIZE];
+
+    /// Mailbox worker for asynchronous SDO requests.
+    L7NHSdoWorker *_sdoWorker;
+
+    /// False after drive rejected a complete access SDO download.
+    bool _completeAccessEnable;
+
+    /// Last error code.
+    std::atomic<uint16_t> _lastError;
+
+    /// SDO statistics entry of one object.
+    struct _SdoStat
+    {
+        std::atomic<uint32_t> key;              ///< (index << 8) | subindex. 0 means free entry.
+        std::atomic<uint32_t> calls;
+        std::atomic<uint32_t> failures;
+        _L7NH::LatencyHistogram latency;        ///< [us]
+    }_sdoStats[L7NH_SDO_STATS_SIZE];
+
+    /// Output file of periodic SDO statistics dump.
+    std::atomic<FILE*> _sdoStatsDumpFile;
+
+    /// Period of SDO statistics dump. [ms]
+    std::atomic<uint32_t> _sdoStatsDumpPeriod;
+
+    /// Time of next SDO statistics dump. [ms since steady clock epoch]
+    std::atomic<int64_t> _sdoStatsDumpNext;
+
     /**
      * @brief _TxMapFlag indexes
      * @note Array cells:
@@ -810,6 +1325,174 @@ private:
      * @note - 11: OperationModeDisplay
      */
     uint8_t _TxMapFlag[12];
+
+    /// Bound address of each TxPDO object. Same indexes as _TxMapFlag. Unbound objects point to _pdoZero.
+    const uint8_t *_txPtr[12];
+
+    /// Bound address of each RxPDO object. Same indexes as _RxMapFlag. Unbound objects point to _rxScratch.
+    uint8_t *_rxPtr[6];
+
+    /// True if the RxPDO object is bound to the process image.
+    bool _rxBound[6];
+
+    /// True after bindPDO() successed.
+    bool _pdoBound;
+
+    /// Sink of unbound RxPDO objects.
+    uint32_t _rxScratch;
+
+    /// Source of unbound TxPDO objects.
+    static constexpr uint32_t _pdoZero = 0;
+
+    /// @brief Point all PDO accessors to _pdoZero and _rxScratch.
+    void _unbindPDO(void);
+
+    /**
+     * @brief Update RX map offsets and flags from mapping entries.
+     * @return false if one entry is not supported.
+     */
+    bool _buildRxMap(uint8_t num_enteries, const uint32_t* mapping_entry);
+
+    /**
+     * @brief Update TX map offsets and flags from mapping entries.
+     * @return false if one entry is not supported.
+     */
+    bool _buildTxMap(uint8_t num_enteries, const uint32_t* mapping_entry);
+
+    /**
+     * @brief Write all entries of an array object by one complete access SDO download.
+     * Subindex 0 is sent as 16 bit value followed by entries.
+     * @param entry_size is byte size of each entry. 2 or 4.
+     * @return true if successed. false if complete access is disabled, not supported or rejected.
+     */
+    bool _writeCompleteAccess(uint16_t index, uint8_t num_enteries, const void* entries, uint8_t entry_size);
+
+    /**
+     * @brief Read number of entries and all entries of an array object.
+     * Complete access SDO upload is used if it is enabled, otherwise each subindex is read.
+     * @param entry_size is byte size of each entry. 2 or 4.
+     * @param max_enteries is capacity of entries buffer.
+     * @return true if successed.
+     */
+    bool _readArrayObject(uint16_t index, uint8_t entry_size, uint8_t max_enteries, uint8_t &num_enteries, void* entries);
+
+    /// Find cache entry of object. nullptr if object is not cached.
+    _CacheEntry* _cacheFind(uint16_t index, uint8_t subindex);
+
+    /**
+     * @brief Get valid cached value of object.
+     * @param size is capacity of data in bytes. It is clamped to cached size and updated with bytes copied.
+     * @return false if object is not cached or cached value is not valid.
+     */
+    bool _cacheGet(uint16_t index, uint8_t subindex, void* data, int *size);
+
+    /// Save value of object in cache if object is cached.
+    void _cachePut(uint16_t index, uint8_t subindex, const void* data, int size);
+
+    /**
+     * @brief SDO upload of this driver. All blocking SDO reads of the class pass from here.
+     * Same as ec_SDOread() of SOEM. Cached objects are returned from object cache.
+     * @param timeout is mailbox timeout. [us]
+     * @return working counter. <= 0 means not successed.
+     */
+    int _SDOread(uint16_t index, uint8_t subindex, boolean complete_access, int *size, void *data, int timeout = EC_TIMEOUTRXM);
+
+    /**
+     * @brief SDO download of this driver. All blocking SDO writes of the class pass from here.
+     * Same as ec_SDOwrite() of SOEM. Cached value of object is invalidated.
+     * @param timeout is mailbox timeout. [us]
+     * @return working counter. <= 0 means not successed.
+     */
+    int _SDOwrite(uint16_t index, uint8_t subindex, boolean complete_access, int size, const void *data, int timeout = EC_TIMEOUTRXM);
+
+    /// Queue store/restore command on mailbox worker and init handle.
+    bool _beginEeprom(uint16_t index, uint8_t subindex, uint32_t command, EepromHandle &handle);
+
+    /// Send store/restore command and wait for its SDO download response.
+    bool _eepromBlocking(uint16_t index, uint8_t subindex, uint32_t command);
+
+    /// Mailbox timeout of store/restore command from EEPROM_DEADLINE. [us]
+    int _eepromTimeout(void);
+
+    /// Record one SDO transfer in statistics.
+    void _sdoStatRecord(uint16_t index, uint8_t subindex, int wkc, std::chrono::steady_clock::time_point start);
+
+    /// Record one SDO transfer in statistics. latency is in [us].
+    void _sdoStatRecord(uint16_t index, uint8_t subindex, int wkc, uint32_t latency);
+
+    /// Observer of mailbox worker requests. user is the L7NH object.
+    static void _sdoStatObserver(const L7NHSdoResult &result, void *user);
+
+    /// Set last error code and push it in deferred log.
+    void _setError(ErrorCode code);
+
+    /// Compare assignment object and mapping object in the drive with requested mapping.
+    bool _isPDOEqual(uint16_t assign_index, uint16_t map_index, uint8_t num_enteries, const uint32_t* mapping_entry);
 };
 
+// ####################################################
+// Template functions:
+
+template<class RxLayout, class TxLayout>
+bool L7NH::configPDO(void)
+{
+    uint32_t map_rx[RxLayout::count];
+    uint32_t map_tx[TxLayout::count];
+
+    for(int i = 0; i < RxLayout::count; i++)
+    {
+        map_rx[i] = RxLayout::entries[i];
+    }
+
+    for(int i = 0; i < TxLayout::count; i++)
+    {
+        map_tx[i] = TxLayout::entries[i];
+    }
+
+    if(configRxPDO(1, RxLayout::count, map_rx) == false)
+        return false;
+
+    if(configTxPDO(1, TxLayout::count, map_tx) == false)
+        return false;
+
+    return true;
+}
+
+template<class Object>
+bool L7NH::read(typename Object::type &data)
+{
+    static_assert(Object::readable, "Object is write only.");
+
+    int size = Object::size;
+
+    if(_SDOread(Object::index, Object::subindex, FALSE, &size, &data) <= 0)
+        return false;
+
+    return (size == Object::size);
+}
+
+template<class Object>
+bool L7NH::write(typename Object::type data)
+{
+    static_assert(Object::writable, "Object is read only.");
+
+    return (_SDOwrite(Object::index, Object::subindex, FALSE, Object::size, &data) > 0);
+}
+
+template<class Object>
+bool L7NH::readAsync(L7NHSdoHandle *handle, L7NHSdoCallback callback, void *user)
+{
+    static_assert(Object::readable, "Object is write only.");
+
+    return readSDOAsync(Object::index, Object::subindex, Object::size, handle, callback, user);
+}
+
+template<class Object>
+bool L7NH::writeAsync(typename Object::type data, L7NHSdoHandle *handle, L7NHSdoCallback callback, void *user)
+{
+    static_assert(Object::writable, "Object is read only.");
+
+    return writeSDOAsync(Object::index, Object::subindex, Object::size, &data, handle, callback, user);
+}
+
 #endif
\ No newline at end of file
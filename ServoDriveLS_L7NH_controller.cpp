@@ -0,0 +1,479 @@
+#include "ServoDriveLS_L7NH_controller.h"
+#include <math.h>                           // llround, lrintf
+
+#if !defined(L7NH_CONTROLLER_FIXED_POINT)
+    #if defined(__AVX2__)
+        #include <immintrin.h>
+    #elif defined(__ARM_NEON)
+        #include <arm_neon.h>
+    #endif
+#endif
+
+// ##################################################################
+// Control law:
+
+#ifdef L7NH_CONTROLLER_FIXED_POINT
+
+// Fraction bits of gains and accumulators.
+static constexpr int _FRACTION_BITS = 16;
+
+// One unit of accumulator.
+static constexpr L7NHControllerAccumulator _ONE = (L7NHControllerAccumulator)1 << _FRACTION_BITS;
+
+// Inputs are limited so sum of four products of int32 gains stays in int64.
+static constexpr int32_t _INPUT_LIMIT = 1 << 28;
+
+static bool _toGain(double gain, L7NHControllerGain &result)
+{
+    double scaled = gain * (double)_ONE;
+
+    if( (isfinite(scaled) == false) || (scaled > (double)INT32_MAX) || (scaled < (double)INT32_MIN) )
+    {
+        return false;
+    }
+
+    result = (L7NHControllerGain)llround(scaled);
+
+    return true;
+}
+
+static inline int64_t _saturate(int32_t x)
+{
+    return (x > _INPUT_LIMIT) ? _INPUT_LIMIT : ( (x < -_INPUT_LIMIT) ? -_INPUT_LIMIT : x );
+}
+
+#else
+
+static constexpr L7NHControllerAccumulator _ONE = 1;
+
+static bool _toGain(double gain, L7NHControllerGain &result)
+{
+    if(isfinite(gain) == false)
+    {
+        return false;
+    }
+
+    result = (L7NHControllerGain)gain;
+
+    return true;
+}
+
+#endif
+
+/**
+ * @brief Control law of one axis.
+ * @return output torque. [0.1%]
+ */
+static inline int32_t _control(L7NHControllerGain kp, L7NHControllerGain kiDt, L7NHControllerGain kd,
+                               L7NHControllerGain kvff, L7NHControllerGain kaff, L7NHControllerAccumulator limit,
+                               L7NHControllerAccumulator &integral, int32_t posRef, int32_t posAct,
+                               int32_t velRef, int32_t velAct, int32_t accRef)
+{
+    // Differences wrap around like the position counter of drive.
+    int32_t ep = (int32_t)((uint32_t)posRef - (uint32_t)posAct);
+    int32_t ev = (int32_t)((uint32_t)velRef - (uint32_t)velAct);
+
+#ifdef L7NH_CONTROLLER_FIXED_POINT
+    int64_t p = (int64_t)kp * _saturate(ep) + (int64_t)kd * _saturate(ev) +
+                (int64_t)kvff * _saturate(velRef) + (int64_t)kaff * _saturate(accRef);
+    int64_t i = integral + (int64_t)kiDt * _saturate(ep);
+#else
+    float p = kp * (float)ep + kd * (float)ev + kvff * (float)velRef + kaff * (float)accRef;
+    float i = integral + kiDt * (float)ep;
+#endif
+
+    // Integral only fills the torque that is left after other terms.
+    L7NHControllerAccumulator high = limit - p;
+    L7NHControllerAccumulator low = -limit - p;
+
+    if(high < 0)
+    {
+        high = 0;
+    }
+    if(low > 0)
+    {
+        low = 0;
+    }
+
+    if(i > high)
+    {
+        i = high;
+    }
+    else if(i < low)
+    {
+        i = low;
+    }
+
+    integral = i;
+
+    L7NHControllerAccumulator u = p + i;
+
+    if(u > limit)
+    {
+        u = limit;
+    }
+    else if(u < -limit)
+    {
+        u = -limit;
+    }
+
+#ifdef L7NH_CONTROLLER_FIXED_POINT
+    return (int32_t)((u + (_ONE >> 1)) >> _FRACTION_BITS);
+#else
+    return (int32_t)lrintf(u);
+#endif
+}
+
+// ##################################################################
+// L7NHController:
+
+L7NHController::L7NHController()
+{
+    parameters.PERIOD = 1000000;
+    parameters.KP = 0;
+    parameters.KI = 0;
+    parameters.KD = 0;
+    parameters.KVFF = 0;
+    parameters.KAFF = 0;
+    parameters.TORQUE_LIMIT = 0;
+
+    _axis = nullptr;
+    _kp = 0;
+    _kiDt = 0;
+    _kd = 0;
+    _kvff = 0;
+    _kaff = 0;
+    _limit = 0;
+    _integral = 0;
+    _position = 0;
+    _velocity = 0;
+    _acceleration = 0;
+    _output = 0;
+}
+
+bool L7NHController::attach(L7NH *axis)
+{
+    if(axis == nullptr)
+    {
+        errorMessage = "Error L7NHController: Axis pointer is null.";
+        return false;
+    }
+
+    _axis = axis;
+
+    return reset();
+}
+
+bool L7NHController::loadTorqueLimit(void)
+{
+    if(_axis == nullptr)
+    {
+        errorMessage = "Error L7NHController: Controller is not attached.";
+        return false;
+    }
+
+    uint16_t torque;
+
+    if(_axis->read<_L7NH::Obj::MaximumTorque>(torque) == false)
+    {
+        errorMessage = "Error L7NHController: MaximumTorque can not be read.";
+        return false;
+    }
+
+    parameters.TORQUE_LIMIT = torque;
+
+    return true;
+}
+
+bool L7NHController::reset(void)
+{
+    if(_axis == nullptr)
+    {
+        errorMessage = "Error L7NHController: Controller is not attached.";
+        return false;
+    }
+
+    if( (parameters.PERIOD == 0) || (parameters.TORQUE_LIMIT > INT16_MAX) )
+    {
+        errorMessage = "Error L7NHController: PERIOD can not be zero and TORQUE_LIMIT must be less than 32768.";
+        return false;
+    }
+
+    double dt = (double)parameters.PERIOD * 1e-9;
+
+    if( (_toGain(parameters.KP, _kp) == false) || (_toGain(parameters.KI * dt, _kiDt) == false) ||
+        (_toGain(parameters.KD, _kd) == false) || (_toGain(parameters.KVFF, _kvff) == false) ||
+        (_toGain(parameters.KAFF, _kaff) == false) )
+    {
+        errorMessage = "Error L7NHController: A gain is out of range.";
+        return false;
+    }
+
+    _limit = (L7NHControllerAccumulator)parameters.TORQUE_LIMIT * _ONE;
+    _integral = 0;
+    _position = _axis->value.posActStep;
+    _velocity = 0;
+    _acceleration = 0;
+    _output = 0;
+
+    return true;
+}
+
+void L7NHController::setReference(int32_t position, int32_t velocity, int32_t acceleration)
+{
+    _position = position;
+    _velocity = velocity;
+    _acceleration = acceleration;
+}
+
+bool L7NHController::update(void)
+{
+    if(_axis == nullptr)
+    {
+        return false;
+    }
+
+    _output = (int16_t)_control(_kp, _kiDt, _kd, _kvff, _kaff, _limit, _integral, _position, _axis->value.posActStep,
+                                _velocity, _axis->value.velActStep, _acceleration);
+
+    return _axis->setTargetTorquePDO(_output);
+}
+
+int16_t L7NHController::getOutput(void)
+{
+    return _output;
+}
+
+bool L7NHController::isSaturated(void)
+{
+    L7NHControllerAccumulator output = (L7NHControllerAccumulator)_output * _ONE;
+
+    return ( (_limit > 0) && ( (output >= _limit) || (output <= -_limit) ) );
+}
+
+// ##################################################################
+// L7NHGroupController:
+
+L7NHGroupController::L7NHGroupController()
+{
+    _group = nullptr;
+
+    memset(&parameters, 0, sizeof(parameters));
+    memset(&reference, 0, sizeof(reference));
+
+    parameters.PERIOD = 1000000;
+
+    for(int i = 0; i < L7NHGROUP_MAX_AXES; i++)
+    {
+        output[i] = 0;
+        _kp[i] = 0;
+        _kiDt[i] = 0;
+        _kd[i] = 0;
+        _kvff[i] = 0;
+        _kaff[i] = 0;
+        _limit[i] = 0;
+        _integral[i] = 0;
+    }
+}
+
+bool L7NHGroupController::attach(L7NHGroup *group)
+{
+    if(group == nullptr)
+    {
+        errorMessage = "Error L7NHGroupController: Group pointer is null.";
+        return false;
+    }
+
+    _group = group;
+
+    return true;
+}
+
+bool L7NHGroupController::loadTorqueLimits(void)
+{
+    if(_group == nullptr)
+    {
+        errorMessage = "Error L7NHGroupController: Controller is not attached.";
+        return false;
+    }
+
+    bool state = true;
+
+    for(int i = 0; i < _group->getAxisCount(); i++)
+    {
+        uint16_t torque;
+
+        if(_group->getAxis(i)->read<_L7NH::Obj::MaximumTorque>(torque) == false)
+        {
+            errorMessage = "Error L7NHGroupController: MaximumTorque of axis " + std::to_string(i) + " can not be read.";
+            state = false;
+            continue;
+        }
+
+        parameters.TORQUE_LIMIT[i] = torque;
+    }
+
+    return state;
+}
+
+bool L7NHGroupController::updateGains(void)
+{
+    if(_group == nullptr)
+    {
+        errorMessage = "Error L7NHGroupController: Controller is not attached.";
+        return false;
+    }
+
+    if(parameters.PERIOD == 0)
+    {
+        errorMessage = "Error L7NHGroupController: PERIOD can not be zero.";
+        return false;
+    }
+
+    double dt = (double)parameters.PERIOD * 1e-9;
+    int num = _group->getAxisCount();
+
+    // Check all axes first, so a wrong parameter does not leave gains half applied.
+    for(int i = 0; i < num; i++)
+    {
+        L7NHControllerGain gain;
+
+        if( (parameters.TORQUE_LIMIT[i] > INT16_MAX) || (_toGain(parameters.KP[i], gain) == false) ||
+            (_toGain(parameters.KI[i] * dt, gain) == false) || (_toGain(parameters.KD[i], gain) == false) ||
+            (_toGain(parameters.KVFF[i], gain) == false) || (_toGain(parameters.KAFF[i], gain) == false) )
+        {
+            errorMessage = "Error L7NHGroupController: A gain or TORQUE_LIMIT of axis " + std::to_string(i) + " is out of range.";
+            return false;
+        }
+    }
+
+    // Padding cells keep zero gains, so they output zero.
+    for(int i = 0; i < num; i++)
+    {
+        _toGain(parameters.KP[i], _kp[i]);
+        _toGain(parameters.KI[i] * dt, _kiDt[i]);
+        _toGain(parameters.KD[i], _kd[i]);
+        _toGain(parameters.KVFF[i], _kvff[i]);
+        _toGain(parameters.KAFF[i], _kaff[i]);
+        _limit[i] = (L7NHControllerAccumulator)parameters.TORQUE_LIMIT[i] * _ONE;
+    }
+
+    return true;
+}
+
+bool L7NHGroupController::reset(void)
+{
+    if(updateGains() == false)
+    {
+        return false;
+    }
+
+    for(int i = 0; i < L7NHGROUP_MAX_AXES; i++)
+    {
+        _integral[i] = 0;
+        output[i] = 0;
+        reference.position[i] = _group->value.posActStep[i];
+        reference.velocity[i] = 0;
+        reference.acceleration[i] = 0;
+    }
+
+    return true;
+}
+
+bool L7NHGroupController::update(void)
+{
+    if(_group == nullptr)
+    {
+        return false;
+    }
+
+    const int32_t *posAct = _group->value.posActStep;
+    const int32_t *velAct = _group->value.velActStep;
+
+    int count = _group->getAxisCount();
+    int num = (count + 7) & ~7;
+    int i = 0;
+
+#if !defined(L7NH_CONTROLLER_FIXED_POINT) && defined(__AVX2__)
+    const __m256 zero = _mm256_setzero_ps();
+
+    for(; i + 8 <= num; i += 8)
+    {
+        __m256i posRef = _mm256_load_si256((const __m256i *)(reference.position + i));
+        __m256i velRef = _mm256_load_si256((const __m256i *)(reference.velocity + i));
+
+        __m256 ep = _mm256_cvtepi32_ps(_mm256_sub_epi32(posRef, _mm256_load_si256((const __m256i *)(posAct + i))));
+        __m256 ev = _mm256_cvtepi32_ps(_mm256_sub_epi32(velRef, _mm256_load_si256((const __m256i *)(velAct + i))));
+        __m256 vr = _mm256_cvtepi32_ps(velRef);
+        __m256 ar = _mm256_cvtepi32_ps(_mm256_load_si256((const __m256i *)(reference.acceleration + i)));
+
+        __m256 p = _mm256_mul_ps(_mm256_load_ps(_kp + i), ep);
+        p = _mm256_add_ps(p, _mm256_mul_ps(_mm256_load_ps(_kd + i), ev));
+        p = _mm256_add_ps(p, _mm256_mul_ps(_mm256_load_ps(_kvff + i), vr));
+        p = _mm256_add_ps(p, _mm256_mul_ps(_mm256_load_ps(_kaff + i), ar));
+
+        __m256 limit = _mm256_load_ps(_limit + i);
+        __m256 high = _mm256_max_ps(_mm256_sub_ps(limit, p), zero);
+        __m256 low = _mm256_min_ps(_mm256_sub_ps(_mm256_sub_ps(zero, limit), p), zero);
+
+        __m256 integral = _mm256_add_ps(_mm256_load_ps(_integral + i), _mm256_mul_ps(_mm256_load_ps(_kiDt + i), ep));
+        integral = _mm256_min_ps(_mm256_max_ps(integral, low), high);
+        _mm256_store_ps(_integral + i, integral);
+
+        __m256 u = _mm256_add_ps(p, integral);
+        u = _mm256_min_ps(_mm256_max_ps(u, _mm256_sub_ps(zero, limit)), limit);
+
+        _mm256_store_si256((__m256i *)(output + i), _mm256_cvtps_epi32(u));
+    }
+#elif !defined(L7NH_CONTROLLER_FIXED_POINT) && defined(__ARM_NEON)
+    const float32x4_t zero = vdupq_n_f32(0);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+
+    for(; i + 4 <= num; i += 4)
+    {
+        int32x4_t posRef = vld1q_s32(reference.position + i);
+        int32x4_t velRef = vld1q_s32(reference.velocity + i);
+
+        float32x4_t ep = vcvtq_f32_s32(vsubq_s32(posRef, vld1q_s32(posAct + i)));
+        float32x4_t ev = vcvtq_f32_s32(vsubq_s32(velRef, vld1q_s32(velAct + i)));
+        float32x4_t vr = vcvtq_f32_s32(velRef);
+        float32x4_t ar = vcvtq_f32_s32(vld1q_s32(reference.acceleration + i));
+
+        float32x4_t p = vmulq_f32(vld1q_f32(_kp + i), ep);
+        p = vaddq_f32(p, vmulq_f32(vld1q_f32(_kd + i), ev));
+        p = vaddq_f32(p, vmulq_f32(vld1q_f32(_kvff + i), vr));
+        p = vaddq_f32(p, vmulq_f32(vld1q_f32(_kaff + i), ar));
+
+        float32x4_t limit = vld1q_f32(_limit + i);
+        float32x4_t high = vmaxq_f32(vsubq_f32(limit, p), zero);
+        float32x4_t low = vminq_f32(vsubq_f32(vnegq_f32(limit), p), zero);
+
+        float32x4_t integral = vaddq_f32(vld1q_f32(_integral + i), vmulq_f32(vld1q_f32(_kiDt + i), ep));
+        integral = vminq_f32(vmaxq_f32(integral, low), high);
+        vst1q_f32(_integral + i, integral);
+
+        float32x4_t u = vaddq_f32(p, integral);
+        u = vminq_f32(vmaxq_f32(u, vnegq_f32(limit)), limit);
+
+        // Round half away from zero.
+        float32x4_t offset = vbslq_f32(vcltq_f32(u, zero), vnegq_f32(half), half);
+        vst1q_s32(output + i, vcvtq_s32_f32(vaddq_f32(u, offset)));
+    }
+#endif
+
+    // Scalar fallback.
+    for(; i < num; i++)
+    {
+        output[i] = _control(_kp[i], _kiDt[i], _kd[i], _kvff[i], _kaff[i], _limit[i], _integral[i],
+                             reference.position[i], posAct[i], reference.velocity[i], velAct[i], reference.acceleration[i]);
+    }
+
+    bool state = true;
+
+    for(i = 0; i < count; i++)
+    {
+        state = _group->getAxis(i)->setTargetTorquePDO((int16_t)output[i]) && state;
+    }
+
+    return state;
+}
@@ -0,0 +1,218 @@
+#ifndef L7NH_CONTROLLER_H
+#define L7NH_CONTROLLER_H
+
+// Header Includes:
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+#include "ServoDriveLS_L7NH_group.h"        // L7NH axis group
+
+// ####################################################
+// Macros:
+
+// Define L7NH_CONTROLLER_FIXED_POINT in compiler flags (eg: -DL7NH_CONTROLLER_FIXED_POINT) to run controllers
+// in Q16.16 integer arithmetic. Execution time does not depend on values and FPU state.
+// It must be the same for all translation units.
+
+#ifdef L7NH_CONTROLLER_FIXED_POINT
+    typedef int32_t L7NHControllerGain;             ///< Gain in Q16.16.
+    typedef int64_t L7NHControllerAccumulator;      ///< Torque in Q16.16. [0.1%]
+#else
+    typedef float L7NHControllerGain;
+    typedef float L7NHControllerAccumulator;
+#endif
+
+// ####################################################
+
+/**
+ * @brief Host side position/velocity controller of one axis for cyclic synchronous torque mode.
+ * Output TargetTorque [0.1%] = KP * position error + integral + KD * velocity error
+ * + KVFF * reference velocity + KAFF * reference acceleration.
+ * @note - Integral is clamped to the torque that is left after other terms (anti-windup),
+ * so it never winds up while output is saturated.
+ * @note - Output is clamped to TORQUE_LIMIT. loadTorqueLimit() reads it from MaximumTorque object of drive.
+ * @note - Feedback is value.posActStep and value.velActStep of axis, so use it after axis updateValuesPDO().
+ * @note - Gains are rounded to 1/65536 in L7NH_CONTROLLER_FIXED_POINT build.
+ */
+class L7NHController
+{
+public:
+
+    /// @brief Last error message accured for object.
+    std::string errorMessage;
+
+    /// @brief Parameters structure. They take effect at reset().
+    struct ParameterStructure
+    {
+        /// @brief Cycle period of update(). [ns]
+        uint32_t PERIOD;
+
+        /// @brief Proportional gain of position error. [0.1%/pulse]
+        float KP;
+
+        /// @brief Integral gain of position error. [0.1%/(pulse*s)]
+        float KI;
+
+        /// @brief Gain of velocity error. [0.1%/(pulse/s)]
+        float KD;
+
+        /// @brief Velocity feedforward gain. eg: viscous friction. [0.1%/(pulse/s)]
+        float KVFF;
+
+        /// @brief Acceleration feedforward gain. eg: inertia. [0.1%/(pulse/s^2)]
+        float KAFF;
+
+        /// @brief Output torque limit. [0.1%]
+        uint16_t TORQUE_LIMIT;
+    }parameters;
+
+    /// @brief Default constructor. Init parameters.
+    L7NHController();
+
+    /**
+     * @brief Attach to an axis and reset controller.
+     * @return true if successed.
+     */
+    bool attach(L7NH *axis);
+
+    /**
+     * @brief Read MaximumTorque of drive in SDO mode and set TORQUE_LIMIT by it.
+     * @return true if successed.
+     * @note Use reset() after it.
+     */
+    bool loadTorqueLimit(void);
+
+    /**
+     * @brief Apply parameters, clear integral and set reference at current actual position with zero velocity.
+     * @return false if not attached or parameters are not correct.
+     */
+    bool reset(void);
+
+    /**
+     * @brief Set reference of next update().
+     * @param position is in [pulses].
+     * @param velocity is in [pulses/s].
+     * @param acceleration is in [pulses/s^2].
+     */
+    void setReference(int32_t position, int32_t velocity = 0, int32_t acceleration = 0);
+
+    /**
+     * @brief Compute output and write TargetTorque of axis in PDO mode.
+     * @return false if not attached or TargetTorque is not in RxPDO mapping.
+     * @note Call it once per cycle from the cyclic thread.
+     */
+    bool update(void);
+
+    /// @brief Get last output torque. [0.1%]
+    int16_t getOutput(void);
+
+    /// @brief true if last output was clamped at TORQUE_LIMIT.
+    bool isSaturated(void);
+
+private:
+
+    L7NH *_axis;
+
+    L7NHControllerGain _kp;
+    L7NHControllerGain _kiDt;       ///< KI * PERIOD.
+    L7NHControllerGain _kd;
+    L7NHControllerGain _kvff;
+    L7NHControllerGain _kaff;
+
+    L7NHControllerAccumulator _limit;
+
+    L7NHControllerAccumulator _integral;
+
+    int32_t _position;
+    int32_t _velocity;
+    int32_t _acceleration;
+
+    int16_t _output;
+};
+
+/**
+ * @brief Controller of all axes of a L7NHGroup for cyclic synchronous torque mode.
+ * Same control law as L7NHController, computed for all axes together in structure-of-arrays form
+ * by vectorized kernels (AVX2 or NEON if the compiler targets them and the build is not fixed point, otherwise scalar).
+ * @note Feedback is group value.posActStep and value.velActStep, so use it after group updateValuesPDO().
+ */
+class L7NHGroupController
+{
+public:
+
+    /// @brief Last error message accured for object.
+    std::string errorMessage;
+
+    /**
+     * @brief Parameters structure. Structure of arrays, index i is the i'th axis of group.
+     * Units are the same as L7NHController parameters. They take effect at updateGains() or reset().
+     */
+    struct ParameterStructure
+    {
+        uint32_t PERIOD;                                        ///< Cycle period of update(). [ns]
+        alignas(32) float KP[L7NHGROUP_MAX_AXES];
+        alignas(32) float KI[L7NHGROUP_MAX_AXES];
+        alignas(32) float KD[L7NHGROUP_MAX_AXES];
+        alignas(32) float KVFF[L7NHGROUP_MAX_AXES];
+        alignas(32) float KAFF[L7NHGROUP_MAX_AXES];
+        uint16_t TORQUE_LIMIT[L7NHGROUP_MAX_AXES];
+    }parameters;
+
+    /// @brief References of next update(). Structure of arrays.
+    struct ReferenceStructure
+    {
+        alignas(32) int32_t position[L7NHGROUP_MAX_AXES];       ///< [pulses]
+        alignas(32) int32_t velocity[L7NHGROUP_MAX_AXES];       ///< [pulses/s]
+        alignas(32) int32_t acceleration[L7NHGROUP_MAX_AXES];   ///< [pulses/s^2]
+    }reference;
+
+    /// @brief Last output torque of axes. [0.1%]
+    alignas(32) int32_t output[L7NHGROUP_MAX_AXES];
+
+    /// @brief Default constructor. Init parameters.
+    L7NHGroupController();
+
+    /**
+     * @brief Attach to a group.
+     * @return true if successed.
+     * @note Add all axes to group before it. Then set parameters and use reset().
+     */
+    bool attach(L7NHGroup *group);
+
+    /**
+     * @brief Read MaximumTorque of all axes in SDO mode and set TORQUE_LIMIT by them.
+     * @return true if successed for all axes.
+     */
+    bool loadTorqueLimits(void);
+
+    /**
+     * @brief Apply parameters without clearing integrals.
+     * @return false if not attached or parameters are not correct.
+     */
+    bool updateGains(void);
+
+    /**
+     * @brief Apply parameters, clear integrals and set references at current actual positions with zero velocity.
+     * @return false if not attached or parameters are not correct.
+     */
+    bool reset(void);
+
+    /**
+     * @brief Compute outputs of all axes and write TargetTorque of them in PDO mode.
+     * @return false if not attached or TargetTorque of an axis is not in RxPDO mapping.
+     * @note Call it once per cycle from the cyclic thread.
+     */
+    bool update(void);
+
+private:
+
+    L7NHGroup *_group;
+
+    alignas(32) L7NHControllerGain _kp[L7NHGROUP_MAX_AXES];
+    alignas(32) L7NHControllerGain _kiDt[L7NHGROUP_MAX_AXES];
+    alignas(32) L7NHControllerGain _kd[L7NHGROUP_MAX_AXES];
+    alignas(32) L7NHControllerGain _kvff[L7NHGROUP_MAX_AXES];
+    alignas(32) L7NHControllerGain _kaff[L7NHGROUP_MAX_AXES];
+    alignas(32) L7NHControllerAccumulator _limit[L7NHGROUP_MAX_AXES];
+    alignas(32) L7NHControllerAccumulator _integral[L7NHGROUP_MAX_AXES];
+};
+
+#endif
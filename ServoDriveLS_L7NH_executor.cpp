@@ -0,0 +1,606 @@
+#include "ServoDriveLS_L7NH_executor.h"
+#include <sys/mman.h>                       // mlockall
+#include <sched.h>                          // CPU affinity
+#include <string.h>                         // strerror
+#include <errno.h>                          // errno
+
+// ##################################################################
+// Time helpers:
+
+static int64_t _timespecToNs(const struct timespec &ts)
+{
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static struct timespec _nsToTimespec(int64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    return ts;
+}
+
+static int64_t _nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return _timespecToNs(ts);
+}
+
+// ##################################################################
+// L7NHExecutor:
+
+L7NHExecutor::L7NHExecutor()
+{
+    parameters.PERIOD = 1000000;
+    parameters.PRIORITY = 80;
+    parameters.CPU = -1;
+    parameters.LOCK_MEMORY = 1;
+    parameters.RECEIVE_TIMEOUT = EC_TIMEOUTRET;
+    parameters.DC_SYNC = 0;
+    parameters.DC_SHIFT = 0;
+    parameters.DC_KP = 0.01;
+    parameters.DC_KI = 0.0005;
+    parameters.TIMING = 1;
+    parameters.WKC_CHECK = 1;
+
+    _axisCount = 0;
+    _machineCount = 0;
+    _homingCount = 0;
+    _mailboxCount = 0;
+    _group = nullptr;
+    _telemetry = nullptr;
+    _cycleCallback = nullptr;
+    _cycleUser = nullptr;
+    _dcIntegral = 0;
+    _wkcExpected = 0;
+
+    _running.store(false);
+    _cycleCount.store(0);
+    _overruns.store(0);
+    _missedPeriods.store(0);
+    _wkcErrors.store(0);
+}
+
+L7NHExecutor::~L7NHExecutor()
+{
+    stop();
+}
+
+bool L7NHExecutor::addAxis(L7NH *axis, L7NHAxisCallback control, L7NHAxisCallback write, void *user)
+{
+    if(_running.load())
+    {
+        errorMessage = "Error L7NHExecutor: Axes can not be added while executor is running.";
+        return false;
+    }
+
+    if(axis == nullptr)
+    {
+        errorMessage = "Error L7NHExecutor: Axis pointer is null.";
+        return false;
+    }
+
+    if(_axisCount >= L7NHEXECUTOR_MAX_AXES)
+    {
+        errorMessage = "Error L7NHExecutor: Number of axes is more than L7NHEXECUTOR_MAX_AXES.";
+        return false;
+    }
+
+    _axes[_axisCount].axis = axis;
+    _axes[_axisCount].control = control;
+    _axes[_axisCount].write = write;
+    _axes[_axisCount].user = user;
+    _axisCount++;
+
+    return true;
+}
+
+bool L7NHExecutor::setGroup(L7NHGroup *group)
+{
+    if(_running.load())
+    {
+        errorMessage = "Error L7NHExecutor: Group can not be changed while executor is running.";
+        return false;
+    }
+
+    _group = group;
+
+    return true;
+}
+
+bool L7NHExecutor::addStateMachine(L7NHStateMachine *machine)
+{
+    if(_running.load())
+    {
+        errorMessage = "Error L7NHExecutor: State machines can not be added while executor is running.";
+        return false;
+    }
+
+    if(machine == nullptr)
+    {
+        errorMessage = "Error L7NHExecutor: State machine pointer is null.";
+        return false;
+    }
+
+    if(_machineCount >= L7NHEXECUTOR_MAX_STATEMACHINES)
+    {
+        errorMessage = "Error L7NHExecutor: Number of state machines is more than L7NHEXECUTOR_MAX_STATEMACHINES.";
+        return false;
+    }
+
+    _machines[_machineCount] = machine;
+    _machineCount++;
+
+    return true;
+}
+
+bool L7NHExecutor::addHoming(L7NHHoming *homing)
+{
+    if(_running.load())
+    {
+        errorMessage = "Error L7NHExecutor: Homing engines can not be added while executor is running.";
+        return false;
+    }
+
+    if(homing == nullptr)
+    {
+        errorMessage = "Error L7NHExecutor: Homing pointer is null.";
+        return false;
+    }
+
+    if(_homingCount >= L7NHEXECUTOR_MAX_HOMINGS)
+    {
+        errorMessage = "Error L7NHExecutor: Number of homing engines is more than L7NHEXECUTOR_MAX_HOMINGS.";
+        return false;
+    }
+
+    _homings[_homingCount] = homing;
+    _homingCount++;
+
+    return true;
+}
+
+bool L7NHExecutor::addMailbox(L7NHSetpointMailbox *mailbox)
+{
+    if(_running.load())
+    {
+        errorMessage = "Error L7NHExecutor: Mailboxes can not be added while executor is running.";
+        return false;
+    }
+
+    if(mailbox == nullptr)
+    {
+        errorMessage = "Error L7NHExecutor: Mailbox pointer is null.";
+        return false;
+    }
+
+    if(_mailboxCount >= L7NHEXECUTOR_MAX_MAILBOXES)
+    {
+        errorMessage = "Error L7NHExecutor: Number of mailboxes is more than L7NHEXECUTOR_MAX_MAILBOXES.";
+        return false;
+    }
+
+    _mailboxes[_mailboxCount] = mailbox;
+    _mailboxCount++;
+
+    return true;
+}
+
+bool L7NHExecutor::setTelemetry(L7NHTelemetry *telemetry)
+{
+    if(_running.load())
+    {
+        errorMessage = "Error L7NHExecutor: Telemetry can not be changed while executor is running.";
+        return false;
+    }
+
+    _telemetry = telemetry;
+
+    return true;
+}
+
+bool L7NHExecutor::setCycleCallback(L7NHCycleCallback callback, void *user)
+{
+    if(_running.load())
+    {
+        errorMessage = "Error L7NHExecutor: Cycle callback can not be changed while executor is running.";
+        return false;
+    }
+
+    _cycleCallback = callback;
+    _cycleUser = user;
+
+    return true;
+}
+
+bool L7NHExecutor::start(void)
+{
+    if(_running.load())
+    {
+        return true;
+    }
+
+    if(parameters.PERIOD == 0)
+    {
+        errorMessage = "Error L7NHExecutor: PERIOD can not be zero.";
+        return false;
+    }
+
+    if( (parameters.PRIORITY < 0) || (parameters.PRIORITY > 99) )
+    {
+        errorMessage = "Error L7NHExecutor: PRIORITY is out of range 0 to 99.";
+        return false;
+    }
+
+    // Resolve process image addresses once. Cyclic PDO accessors then only copy bytes.
+    for(int i = 0; i < _axisCount; i++)
+    {
+        if(_axes[i].axis->bindPDO() == false)
+        {
+            errorMessage = std::string("Error L7NHExecutor: PDO of one axis can not be bound. ") +
+                           L7NH::getErrorDescription(_axes[i].axis->getLastError());
+            return false;
+        }
+    }
+
+    if(_group != nullptr)
+    {
+        for(int i = 0; i < _group->getAxisCount(); i++)
+        {
+            if(_group->getAxis(i)->bindPDO() == false)
+            {
+                errorMessage = std::string("Error L7NHExecutor: PDO of one group axis can not be bound. ") +
+                               L7NH::getErrorDescription(_group->getAxis(i)->getLastError());
+                return false;
+            }
+        }
+    }
+
+    if(parameters.LOCK_MEMORY == 1)
+    {
+#ifdef MCL_ONFAULT
+        // Current pages are faulted in and locked now. Later mappings are locked only when their pages are
+        // touched, so mapping a big file (eg: L7NHPlayback) does not read and lock the whole file.
+        int state = mlockall(MCL_CURRENT);
+
+        if(state == 0)
+        {
+            state = mlockall(MCL_FUTURE | MCL_ONFAULT);
+        }
+#else
+        int state = mlockall(MCL_CURRENT | MCL_FUTURE);
+#endif
+
+        if(state != 0)
+        {
+            errorMessage = std::string("Error L7NHExecutor: mlockall() was not successed. ") + strerror(errno);
+            return false;
+        }
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    if(parameters.PRIORITY > 0)
+    {
+        struct sched_param param;
+        param.sched_priority = parameters.PRIORITY;
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+
+    if(parameters.CPU >= 0)
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(parameters.CPU, &cpuset);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
+    }
+
+    _dcIntegral = 0;
+    _wkcExpected = ec_group[0].outputsWKC * 2 + ec_group[0].inputsWKC;
+    _cycleCount.store(0);
+    resetTiming();
+    _running.store(true);
+
+    int result = pthread_create(&_thread, &attr, &L7NHExecutor::_threadEntry, this);
+    pthread_attr_destroy(&attr);
+
+    if(result != 0)
+    {
+        _running.store(false);
+        errorMessage = std::string("Error L7NHExecutor: Cyclic thread can not be created. ") + strerror(result);
+        return false;
+    }
+
+    return true;
+}
+
+void L7NHExecutor::stop(void)
+{
+    if(_running.exchange(false) == false)
+    {
+        return;
+    }
+
+    pthread_join(_thread, nullptr);
+}
+
+bool L7NHExecutor::isRunning(void)
+{
+    return _running.load();
+}
+
+uint64_t L7NHExecutor::getCycleCount(void)
+{
+    return _cycleCount.load(std::memory_order_relaxed);
+}
+
+const _L7NH::LatencyHistogram& L7NHExecutor::getTimingHistogram(TimingProbe probe)
+{
+    if( (probe < 0) || (probe >= TIMING_PROBE_NUM) )
+    {
+        probe = TIMING_CYCLE;
+    }
+
+    return _timing[probe];
+}
+
+uint64_t L7NHExecutor::getOverrunCount(void)
+{
+    return _overruns.load(std::memory_order_relaxed);
+}
+
+uint64_t L7NHExecutor::getMissedPeriodCount(void)
+{
+    return _missedPeriods.load(std::memory_order_relaxed);
+}
+
+uint64_t L7NHExecutor::getWkcErrorCount(void)
+{
+    return _wkcErrors.load(std::memory_order_relaxed);
+}
+
+void L7NHExecutor::resetTiming(void)
+{
+    for(int i = 0; i < TIMING_PROBE_NUM; i++)
+    {
+        _timing[i].reset();
+    }
+
+    _overruns.store(0, std::memory_order_relaxed);
+    _missedPeriods.store(0, std::memory_order_relaxed);
+    _wkcErrors.store(0, std::memory_order_relaxed);
+}
+
+void L7NHExecutor::dumpTiming(FILE *file)
+{
+    static const char* names[TIMING_PROBE_NUM] = {"wake jitter", "round trip", "callback", "cycle"};
+
+    fprintf(file, "Executor timing: period %u ns, cycles %lu, overruns %lu, missed periods %lu, wkc errors %lu\n", parameters.PERIOD,
+            (unsigned long)getCycleCount(), (unsigned long)getOverrunCount(), (unsigned long)getMissedPeriodCount(),
+            (unsigned long)getWkcErrorCount());
+    fprintf(file, "  probe            min[ns]   p50[ns]   p99[ns] p99.9[ns]   max[ns]\n");
+
+    for(int i = 0; i < TIMING_PROBE_NUM; i++)
+    {
+        const _L7NH::LatencyHistogram &hist = _timing[i];
+
+        fprintf(file, "  %-12s %9u %9u %9u %9u %9u\n", names[i], hist.min(), hist.percentile(50), hist.percentile(99),
+                hist.percentile(99.9), hist.max());
+    }
+
+    fflush(file);
+}
+
+void* L7NHExecutor::_threadEntry(void *arg)
+{
+    ((L7NHExecutor*)arg)->_loop();
+    return nullptr;
+}
+
+void L7NHExecutor::_loop(void)
+{
+    L7NHCycleInfo info;
+    info.cycle = 0;
+    info.period = parameters.PERIOD;
+    info.wkc = 0;
+    info.wkcExpected = _wkcExpected;
+    info.wkcValid = false;
+    info.dcOffset = 0;
+
+    int64_t next = _nowNs() + parameters.PERIOD;
+
+    while(_running.load(std::memory_order_relaxed))
+    {
+        struct timespec ts = _nsToTimespec(next);
+
+        // Absolute deadline, so sleep error does not accumulate. Retry if interrupted by a signal.
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR);
+
+        int64_t wake = _nowNs();
+
+        info.wakeTime = next;
+
+        _cycle(info, wake);
+
+        info.cycle++;
+        _cycleCount.store(info.cycle, std::memory_order_relaxed);
+
+        int64_t deadline = next;
+
+        next += (int64_t)parameters.PERIOD + info.dcOffset;
+
+        int64_t now = _nowNs();
+
+        _record(TIMING_CYCLE, now - deadline);
+
+        // Skip periods that are already passed. The cycle stays on its phase.
+        if(next <= now)
+        {
+            int64_t missed = (now - next) / parameters.PERIOD + 1;
+
+            next += missed * (int64_t)parameters.PERIOD;
+
+            _overruns.fetch_add(1, std::memory_order_relaxed);
+            _missedPeriods.fetch_add(missed, std::memory_order_relaxed);
+        }
+    }
+}
+
+void L7NHExecutor::_cycle(L7NHCycleInfo &info, int64_t wake)
+{
+    _record(TIMING_WAKE_JITTER, wake - info.wakeTime);
+
+    for(int i = 0; i < _mailboxCount; i++)
+    {
+        _mailboxes[i]->apply();
+    }
+
+    ec_send_processdata();
+    info.wkc = ec_receive_processdata(parameters.RECEIVE_TIMEOUT);
+
+    int64_t received = _nowNs();
+
+    _record(TIMING_ROUND_TRIP, received - wake);
+
+    // Lost or partial frame. Inputs are stale, so no phase runs on them.
+    info.wkcValid = (info.wkc == info.wkcExpected);
+
+    if(info.wkcValid == false)
+    {
+        _wkcErrors.fetch_add(1, std::memory_order_relaxed);
+
+        if(parameters.WKC_CHECK != 0)
+        {
+            info.dcOffset = 0;
+            return;
+        }
+    }
+
+    // Read:
+    for(int i = 0; i < _axisCount; i++)
+    {
+        _axes[i].axis->updateValuesPDO();
+    }
+
+    if(_group != nullptr)
+    {
+        _group->updateValuesPDO();
+    }
+
+    for(int i = 0; i < _machineCount; i++)
+    {
+        _machines[i]->update();
+    }
+
+    for(int i = 0; i < _homingCount; i++)
+    {
+        _homings[i]->update();
+    }
+
+    if(_telemetry != nullptr)
+    {
+        for(int i = 0; i < _axisCount; i++)
+        {
+            _telemetry->push(*_axes[i].axis, i, info.cycle, received);
+        }
+    }
+
+    // Control:
+    for(int i = 0; i < _axisCount; i++)
+    {
+        if(_axes[i].control != nullptr)
+        {
+            _axes[i].control(*_axes[i].axis, info, _axes[i].user);
+        }
+    }
+
+    if(_cycleCallback != nullptr)
+    {
+        _cycleCallback(info, _cycleUser);
+    }
+
+    // Write:
+    for(int i = 0; i < _axisCount; i++)
+    {
+        if(_axes[i].write != nullptr)
+        {
+            _axes[i].write(*_axes[i].axis, info, _axes[i].user);
+        }
+    }
+
+    _record(TIMING_CALLBACK, _nowNs() - received);
+
+    // ec_DCtime is not updated by a lost frame. Its old phase error must not be applied again.
+    info.dcOffset = info.wkcValid ? _dcCorrection() : 0;
+}
+
+void L7NHExecutor::_record(TimingProbe probe, int64_t duration)
+{
+    if(parameters.TIMING == 0)
+    {
+        return;
+    }
+
+    if(duration < 0)
+    {
+        duration = 0;
+    }
+    else if(duration > UINT32_MAX)
+    {
+        duration = UINT32_MAX;
+    }
+
+    _timing[probe].record((uint32_t)duration);
+}
+
+int32_t L7NHExecutor::_dcCorrection(void)
+{
+    if( (parameters.DC_SYNC == 0) || (ec_DCtime <= 0) )
+    {
+        return 0;
+    }
+
+    int64_t period = parameters.PERIOD;
+
+    // Phase error of this cycle against DC cycle start plus shift, in range [-period/2, period/2).
+    int64_t delta = (ec_DCtime - parameters.DC_SHIFT) % period;
+    if(delta < 0)
+    {
+        delta += period;
+    }
+    if(delta >= period / 2)
+    {
+        delta -= period;
+    }
+
+    // Limit correction of one cycle to a quarter of period.
+    float limit = (float)(period / 4);
+
+    _dcIntegral += (float)delta;
+
+    // Anti windup.
+    if( (parameters.DC_KI > 0) && (parameters.DC_KI * _dcIntegral > limit) )
+    {
+        _dcIntegral = limit / parameters.DC_KI;
+    }
+    else if( (parameters.DC_KI > 0) && (parameters.DC_KI * _dcIntegral < -limit) )
+    {
+        _dcIntegral = -limit / parameters.DC_KI;
+    }
+
+    float correction = -(parameters.DC_KP * (float)delta + parameters.DC_KI * _dcIntegral);
+    if(correction > limit)
+    {
+        correction = limit;
+    }
+    else if(correction < -limit)
+    {
+        correction = -limit;
+    }
+
+    return (int32_t)correction;
+}
@@ -0,0 +1,289 @@
+#ifndef L7NH_EXECUTOR_H
+#define L7NH_EXECUTOR_H
+
+// Header Includes:
+#include <pthread.h>                                // For real-time thread attributes
+#include <time.h>                                   // clock_nanosleep
+#include <stdio.h>                                  // For timing dump
+#include "ServoDriveLS_L7NH.h"                      // L7NH motor driver
+#include "ServoDriveLS_L7NH_group.h"                // Group of axes
+#include "ServoDriveLS_L7NH_stateMachine.h"         // CiA402 state machine
+#include "ServoDriveLS_L7NH_homing.h"               // Homing engine
+#include "ServoDriveLS_L7NH_setpoint.h"             // Setpoint mailbox
+#include "ServoDriveLS_L7NH_telemetry.h"            // Telemetry ring
+#include "ServoDriveLS_L7NH_histogram.h"            // Lock-free latency histogram
+
+// ####################################################
+// Macros:
+
+// Maximum number of axes in one executor.
+#define L7NHEXECUTOR_MAX_AXES           64
+
+// Maximum number of state machines in one executor.
+#define L7NHEXECUTOR_MAX_STATEMACHINES  64
+
+// Maximum number of homing engines in one executor.
+#define L7NHEXECUTOR_MAX_HOMINGS        64
+
+// Maximum number of setpoint mailboxes in one executor.
+#define L7NHEXECUTOR_MAX_MAILBOXES      64
+
+// ####################################################
+
+/// @brief Information of current cycle. Passed to all cyclic callbacks.
+struct L7NHCycleInfo
+{
+    uint64_t cycle;                 ///< Cycle counter. Starts from 0.
+    int64_t wakeTime;               ///< Scheduled wake up time of cycle. CLOCK_MONOTONIC. [ns]
+    uint32_t period;                ///< Cycle period. [ns]
+    int wkc;                        ///< Working counter of the process data frame received in this cycle.
+    int wkcExpected;                ///< Expected working counter of group 0. outputsWKC * 2 + inputsWKC.
+    bool wkcValid;                  ///< true if wkc equals wkcExpected. Inputs of this cycle are fresh.
+    int32_t dcOffset;               ///< Phase correction applied to next wake up time for DC alignment. [ns]
+};
+
+/**
+ * @brief Cyclic callback of one axis.
+ * @note It runs on the real-time thread. Do not block, allocate or print in it.
+ */
+typedef void (*L7NHAxisCallback)(L7NH &axis, const L7NHCycleInfo &info, void *user);
+
+/**
+ * @brief Cyclic callback of whole executor.
+ * @note It runs on the real-time thread. Do not block, allocate or print in it.
+ */
+typedef void (*L7NHCycleCallback)(const L7NHCycleInfo &info, void *user);
+
+/**
+ * @brief Real-time cyclic executor of the process data loop.
+ * It owns one thread that wakes at absolute deadlines by clock_nanosleep(TIMER_ABSTIME) and runs each cycle in a fixed order:
+ * @note 1. Apply setpoint mailboxes, then send process image and receive it back.
+ * Outputs written in the previous cycle and the latest published setpoints leave at the start of this cycle.
+ * @note 2. Read: take snapshot and update values of all axes and group, then update state machines and push telemetry.
+ * @note 3. Control: axis control callbacks in adding order, then cycle callback.
+ * @note 4. Write: axis write callbacks in adding order. They set setpoints in the process image.
+ * @note 5. Correct next wake time to distributed clock phase if DC_SYNC is enabled.
+ * @note If WKC_CHECK is enabled, a cycle with a lost or partial frame skips phases 2 to 4 and is counted as wkc error.
+ * Outputs of the previous cycle stay in the process image and are sent again.
+ * @note A cycle with a lost or partial frame never runs phase 5. Its dcOffset is 0 and the DC integrator is kept.
+ * @note Axes, callbacks, group and state machines can only be changed while executor is stopped.
+ * @note Cycle timing is recorded by monotonic clock in lock-free histograms. They can be read from any thread.
+ */
+class L7NHExecutor
+{
+public:
+
+    /// @brief Last error message accured for object.
+    std::string errorMessage;
+
+    /// @brief Timing probes of cycle.
+    enum TimingProbe
+    {
+        TIMING_WAKE_JITTER = 0,     ///< Actual wake up time minus scheduled wake up time. [ns]
+        TIMING_ROUND_TRIP,          ///< Send and receive of process data. [ns]
+        TIMING_CALLBACK,            ///< Read, control and write phases. [ns]
+        TIMING_CYCLE,               ///< Scheduled wake up to end of cycle. [ns]
+        TIMING_PROBE_NUM
+    };
+
+    /// @brief Parameters structure.
+    struct ParameterStructure
+    {
+        /// @brief Cycle period. [ns] eg: 1000000 for 1 kHz.
+        uint32_t PERIOD;
+
+        /**
+         * @brief SCHED_FIFO priority of cyclic thread. Range: 1 to 99.
+         * @note 0 means normal scheduling (SCHED_OTHER). Useful for test without real-time permissions.
+         */
+        int PRIORITY;
+
+        /// @brief CPU core that cyclic thread is pinned to. -1 means no affinity.
+        int CPU;
+
+        /**
+         * @brief Lock process memory by mlockall() on start. 0: disable, 1: enable.
+         * @note It needs root or enough RLIMIT_MEMLOCK. Otherwise start() fails.
+         * @note Mappings made after start() are locked on fault (MCL_ONFAULT) where the system supports it.
+         */
+        uint8_t LOCK_MEMORY;
+
+        /// @brief Timeout of receive process data. [us]
+        int RECEIVE_TIMEOUT;
+
+        /**
+         * @brief Align cycle phase to EtherCAT distributed clock. 0: disable, 1: enable.
+         * @note DC must be configured and ec_DCtime must be updated by receive process data.
+         */
+        uint8_t DC_SYNC;
+
+        /// @brief Wanted phase of cycle wake up after DC cycle start. [ns]
+        int32_t DC_SHIFT;
+
+        /// @brief Proportional gain of DC phase controller. [ns/ns]
+        float DC_KP;
+
+        /// @brief Integral gain of DC phase controller. [ns/(ns.cycle)]
+        float DC_KI;
+
+        /// @brief Record cycle timing histograms. 0: disable, 1: enable. Overruns are always counted.
+        uint8_t TIMING;
+
+        /**
+         * @brief Check working counter of each cycle. 0: disable, 1: enable.
+         * @note If enabled, read, control and write phases are skipped when wkc is not the expected value,
+         * so no callback runs on stale inputs. Mismatches are always counted.
+         */
+        uint8_t WKC_CHECK;
+    }parameters;
+
+    /// @brief Default constructor. Init parameters.
+    L7NHExecutor();
+
+    /// @brief Destructor. Stop cyclic thread.
+    ~L7NHExecutor();
+
+    /**
+     * @brief Add an axis with its callbacks. Callbacks are called in adding order.
+     * @param control is optional control callback.
+     * @param write is optional setpoint write callback.
+     * @return true if successed.
+     */
+    bool addAxis(L7NH *axis, L7NHAxisCallback control, L7NHAxisCallback write = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Set a group that is updated in read phase. nullptr removes it.
+     * @note Group axes are updated by group->updateValuesPDO(). Do not add them by addAxis() unless they need callbacks.
+     */
+    bool setGroup(L7NHGroup *group);
+
+    /**
+     * @brief Add a state machine that is updated in read phase after snapshots.
+     * @note Its axis must be added by addAxis() (callbacks can be nullptr), so its snapshot is taken each cycle.
+     */
+    bool addStateMachine(L7NHStateMachine *machine);
+
+    /**
+     * @brief Add a homing engine that is updated in read phase after state machines.
+     * @note Its axis must be added by addAxis() (callbacks can be nullptr), so its snapshot is taken each cycle.
+     */
+    bool addHoming(L7NHHoming *homing);
+
+    /**
+     * @brief Add a setpoint mailbox that is applied at the start of each cycle, just before sending process data.
+     * @note Mailbox fields overwrite the same fields written by write callbacks in the previous cycle.
+     */
+    bool addMailbox(L7NHSetpointMailbox *mailbox);
+
+    /**
+     * @brief Set a telemetry ring. nullptr removes it.
+     * A sample of each added axis is pushed in read phase. Sample axis index is the adding order of axis.
+     */
+    bool setTelemetry(L7NHTelemetry *telemetry);
+
+    /// @brief Set cycle callback. It is called after all axis control callbacks.
+    bool setCycleCallback(L7NHCycleCallback callback, void *user = nullptr);
+
+    /**
+     * @brief Start cyclic thread.
+     * @return true if successed.
+     * @note Axes and group axes are bound to process image by L7NH::bindPDO(). Use it after ethercat configMap().
+     */
+    bool start(void);
+
+    /// @brief Stop cyclic thread and wait for it.
+    void stop(void);
+
+    /// @brief true if cyclic thread is running.
+    bool isRunning(void);
+
+    /// @brief Get number of completed cycles.
+    uint64_t getCycleCount(void);
+
+    /// @brief Get histogram of a timing probe. eg: getTimingHistogram(L7NHExecutor::TIMING_WAKE_JITTER).percentile(99)
+    const _L7NH::LatencyHistogram& getTimingHistogram(TimingProbe probe);
+
+    /// @brief Get number of cycles that ended after the next wake up deadline.
+    uint64_t getOverrunCount(void);
+
+    /// @brief Get number of periods skipped because of overruns.
+    uint64_t getMissedPeriodCount(void);
+
+    /// @brief Get number of cycles whose working counter was not the expected value.
+    uint64_t getWkcErrorCount(void);
+
+    /// @brief Clear timing histograms, overrun and wkc error counters.
+    void resetTiming(void);
+
+    /// @brief Print timing table in file. eg: dumpTiming(stdout)
+    void dumpTiming(FILE *file);
+
+private:
+
+    struct _Axis
+    {
+        L7NH *axis;
+        L7NHAxisCallback control;
+        L7NHAxisCallback write;
+        void *user;
+    }_axes[L7NHEXECUTOR_MAX_AXES];
+
+    int _axisCount;
+
+    L7NHStateMachine *_machines[L7NHEXECUTOR_MAX_STATEMACHINES];
+
+    int _machineCount;
+
+    L7NHHoming *_homings[L7NHEXECUTOR_MAX_HOMINGS];
+
+    int _homingCount;
+
+    L7NHSetpointMailbox *_mailboxes[L7NHEXECUTOR_MAX_MAILBOXES];
+
+    int _mailboxCount;
+
+    L7NHGroup *_group;
+
+    L7NHTelemetry *_telemetry;
+
+    L7NHCycleCallback _cycleCallback;
+
+    void *_cycleUser;
+
+    pthread_t _thread;
+
+    std::atomic<bool> _running;
+
+    std::atomic<uint64_t> _cycleCount;
+
+    /// Integral state of DC phase controller. [ns]
+    float _dcIntegral;
+
+    _L7NH::LatencyHistogram _timing[TIMING_PROBE_NUM];
+
+    std::atomic<uint64_t> _overruns;
+
+    std::atomic<uint64_t> _missedPeriods;
+
+    std::atomic<uint64_t> _wkcErrors;
+
+    /// Expected working counter of group 0. Taken on start().
+    int _wkcExpected;
+
+    /// Thread entry.
+    static void* _threadEntry(void *arg);
+
+    /// Cyclic loop.
+    void _loop(void);
+
+    /// Run one cycle. wake is actual wake up time. [ns]
+    void _cycle(L7NHCycleInfo &info, int64_t wake);
+
+    /// Record a duration in timing histogram. [ns]
+    void _record(TimingProbe probe, int64_t duration);
+
+    /// Get phase correction of next wake time from distributed clock. [ns]
+    int32_t _dcCorrection(void);
+};
+
+#endif
@@ -0,0 +1,326 @@
+#include "ServoDriveLS_L7NH_gear.h"
+#include <math.h>                           // llround
+
+/// Floor division for signed values. b must be more than zero.
+static inline int64_t _floorDiv(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+
+    if( ((a % b) != 0) && (a < 0) )
+    {
+        q--;
+    }
+
+    return q;
+}
+
+L7NHGear::L7NHGear()
+{
+    parameters.PERIOD = 1000000;
+    parameters.PHASE_VELOCITY = 0;
+    parameters.PHASE_ACCELERATION = 0;
+    parameters.CAM_INTERPOLATION = 1;
+
+    memset(_cams, 0, sizeof(_cams));
+
+    _master = nullptr;
+    _follower = nullptr;
+    _mode.store(MODE_NONE);
+    _ratioRequest.store(0);
+    _ratioPending.store(false);
+    _camPending.store(-1);
+    _stopPending.store(false);
+    _camActive.store(0);
+    _first = true;
+    _masterLast = 0;
+    _masterAbs = 0;
+    _num = 0;
+    _den = 1;
+    _origin = 0;
+    _travel = 0;
+    _camPeriod = 0;
+    _output = 0;
+    _phaseTarget.store(0);
+    _phase = 0;
+    _phaseVelocity = 0;
+    _phaseRounded = 0;
+    _phaseOut.store(0);
+    _shifting.store(false);
+}
+
+bool L7NHGear::attach(L7NH *master, L7NH *follower)
+{
+    if( (master == nullptr) || (follower == nullptr) )
+    {
+        return false;
+    }
+
+    _master = master;
+    _follower = follower;
+    _mode.store(MODE_NONE);
+    _first = true;
+
+    return true;
+}
+
+bool L7NHGear::setRatio(int32_t num, uint32_t den)
+{
+    if(den == 0)
+    {
+        return false;
+    }
+
+    _ratioRequest.store( ((uint64_t)(uint32_t)num << 32) | den, std::memory_order_relaxed);
+    _ratioPending.store(true, std::memory_order_release);
+
+    return true;
+}
+
+bool L7NHGear::loadCam(const int32_t *points, int count, uint32_t period)
+{
+    if( (points == nullptr) || (count < 1) || (count > L7NH_GEAR_MAX_CAM_POINTS) || (period == 0) )
+    {
+        return false;
+    }
+
+    // Previous table is not taken yet. Its buffer is still in use.
+    if(_camPending.load(std::memory_order_acquire) >= 0)
+    {
+        return false;
+    }
+
+    int index = 1 - _camActive.load(std::memory_order_acquire);
+    _Cam &cam = _cams[index];
+
+    memcpy(cam.points, points, sizeof(int32_t) * (count + 1));
+    cam.count = count;
+    cam.period = period;
+
+    _camPending.store((int8_t)index, std::memory_order_release);
+
+    return true;
+}
+
+void L7NHGear::shiftPhase(int32_t shift)
+{
+    _phaseTarget.fetch_add(shift, std::memory_order_relaxed);
+}
+
+void L7NHGear::stop(void)
+{
+    _stopPending.store(true, std::memory_order_release);
+}
+
+bool L7NHGear::update(void)
+{
+    if( (_master == nullptr) || (_follower == nullptr) || (parameters.PERIOD == 0) )
+    {
+        return false;
+    }
+
+    int32_t master = _master->value.posActStep;
+
+    if(_first)
+    {
+        _masterLast = master;
+        _masterAbs = master;
+        _first = false;
+    }
+
+    // Difference wraps around like the position counter of drive.
+    int32_t delta = (int32_t)((uint32_t)master - (uint32_t)_masterLast);
+    _masterLast = master;
+    _masterAbs += delta;
+
+    _rampPhase();
+
+    int64_t phase = llround(_phase);
+    int64_t phaseDelta = phase - _phaseRounded;
+    _phaseRounded = phase;
+
+    uint8_t mode = _mode.load(std::memory_order_relaxed);
+
+    // Follower starts from last command if coupled, else from its actual position.
+    int64_t start = (mode == MODE_NONE) ? (int64_t)_follower->value.posActStep : _output;
+
+    if(_stopPending.exchange(false, std::memory_order_acquire))
+    {
+        mode = MODE_NONE;
+        _mode.store(mode, std::memory_order_relaxed);
+    }
+
+    if(_ratioPending.exchange(false, std::memory_order_acquire))
+    {
+        uint64_t ratio = _ratioRequest.load(std::memory_order_relaxed);
+
+        _num = (int32_t)(uint32_t)(ratio >> 32);
+        _den = (uint32_t)ratio;
+        _origin = start;
+        _travel = 0;
+        phaseDelta = 0;
+
+        mode = MODE_GEAR;
+        _mode.store(mode, std::memory_order_relaxed);
+    }
+
+    int8_t pending = _camPending.load(std::memory_order_acquire);
+
+    if( (pending >= 0) && (mode != MODE_CAM) )
+    {
+        _camActive.store(pending, std::memory_order_relaxed);
+        _camPending.store(-1, std::memory_order_release);
+
+        const _Cam &cam = _cams[pending];
+        int64_t position = _masterAbs + phase;
+
+        _origin = start - _camValue(cam, position);
+        _camPeriod = _floorDiv(position, cam.period);
+        pending = -1;
+
+        mode = MODE_CAM;
+        _mode.store(mode, std::memory_order_relaxed);
+    }
+
+    switch(mode)
+    {
+        case MODE_GEAR:
+        {
+            _travel += (int64_t)delta + phaseDelta;
+
+            // Move whole multiples of den to origin, so products never grow and no remainder is lost.
+            // Floor division keeps _travel in [0, den), so output is floor(total travel * num / den) on any path.
+            int64_t whole = _floorDiv(_travel, _den);
+            _origin += whole * _num;
+            _travel -= whole * (int64_t)_den;
+
+            _output = _origin + _floorDiv(_travel * _num, _den);
+        }
+        break;
+        case MODE_CAM:
+        {
+            int64_t position = _masterAbs + phase;
+            int64_t period = _floorDiv(position, _cams[_camActive.load(std::memory_order_relaxed)].period);
+
+            // New table takes effect on period boundary. Origin keeps follower position continuous.
+            if( (pending >= 0) && (period != _camPeriod) )
+            {
+                const _Cam &previous = _cams[_camActive.load(std::memory_order_relaxed)];
+                const _Cam &cam = _cams[pending];
+
+                _origin += _camValue(previous, position) - _camValue(cam, position);
+                period = _floorDiv(position, cam.period);
+
+                _camActive.store(pending, std::memory_order_relaxed);
+                _camPending.store(-1, std::memory_order_release);
+            }
+
+            _camPeriod = period;
+            _output = _origin + _camValue(_cams[_camActive.load(std::memory_order_relaxed)], position);
+        }
+        break;
+        default:
+            return true;
+    }
+
+    return _follower->setTargetPositionPDO((int32_t)(uint32_t)_output);
+}
+
+L7NHGear::Mode L7NHGear::getMode(void)
+{
+    return (Mode)_mode.load(std::memory_order_relaxed);
+}
+
+int32_t L7NHGear::getFollowerPosition(void)
+{
+    return (int32_t)(uint32_t)_output;
+}
+
+int64_t L7NHGear::getPhase(void)
+{
+    return _phaseOut.load(std::memory_order_relaxed);
+}
+
+bool L7NHGear::isPhaseShifting(void)
+{
+    // A shift that update() has not seen yet makes target differ from the phase at rest.
+    return _shifting.load(std::memory_order_relaxed) ||
+           (_phaseTarget.load(std::memory_order_relaxed) != _phaseOut.load(std::memory_order_relaxed));
+}
+
+void L7NHGear::_rampPhase(void)
+{
+    double target = (double)_phaseTarget.load(std::memory_order_relaxed);
+
+    if( (target != _phase) || (_phaseVelocity != 0) )
+    {
+        double vmax = parameters.PHASE_VELOCITY;
+        double amax = parameters.PHASE_ACCELERATION;
+
+        // Without limits, phase jumps to target.
+        if( (vmax <= 0) || (amax <= 0) )
+        {
+            _phase = target;
+            _phaseVelocity = 0;
+        }
+        else
+        {
+            _L7NH::rampStep(target, vmax, amax, (double)parameters.PERIOD * 1e-9, _phase, _phaseVelocity);
+        }
+    }
+
+    _phaseOut.store(llround(_phase), std::memory_order_relaxed);
+
+    // Only the cyclic thread writes it, so a shift requested in the middle of this cycle is not lost.
+    _shifting.store( (target != _phase) || (_phaseVelocity != 0), std::memory_order_relaxed);
+}
+
+int64_t L7NHGear::_camPoint(const _Cam &cam, int64_t k)
+{
+    int64_t rise = (int64_t)cam.points[cam.count] - cam.points[0];
+
+    if(k < 0)
+    {
+        return (int64_t)cam.points[k + cam.count] - rise;
+    }
+
+    if(k > cam.count)
+    {
+        return (int64_t)cam.points[k - cam.count] + rise;
+    }
+
+    return cam.points[k];
+}
+
+int64_t L7NHGear::_camValue(const _Cam &cam, int64_t phase)
+{
+    int64_t period = _floorDiv(phase, cam.period);
+    int64_t rest = phase - period * cam.period;
+
+    // Table interval and fraction in it. rest * count stays in int64 because rest < 2^32 and count <= 1024.
+    int64_t scaled = rest * cam.count;
+    int64_t i = scaled / cam.period;
+    double t = (double)(scaled - i * cam.period) / (double)cam.period;
+
+    int64_t p1 = _camPoint(cam, i);
+    int64_t p2 = _camPoint(cam, i + 1);
+
+    double value;
+
+    if(parameters.CAM_INTERPOLATION != 0)
+    {
+        double p0 = (double)(_camPoint(cam, i - 1) - p1);
+        double p3 = (double)(_camPoint(cam, i + 2) - p1);
+        double d2 = (double)(p2 - p1);
+
+        // Catmull-Rom spline between p1 and p2, relative to p1 to keep precision.
+        value = 0.5 * t * ( (d2 - p0) + t * ( (2.0 * p0 + 4.0 * d2 - p3) + t * (-3.0 * d2 + p3 - p0) ) );
+    }
+    else
+    {
+        value = (double)(p2 - p1) * t;
+    }
+
+    int64_t rise = (int64_t)cam.points[cam.count] - cam.points[0];
+
+    return period * rise + p1 + llround(value);
+}
@@ -0,0 +1,175 @@
+#ifndef L7NH_GEAR_H
+#define L7NH_GEAR_H
+
+// Header Includes:
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+#include "ServoDriveLS_L7NH_trajectory.h"   // Shared ramp of phase shift
+
+// ####################################################
+// Macros:
+
+// Maximum number of cam table points in one master period.
+#define L7NH_GEAR_MAX_CAM_POINTS        1024
+
+// ####################################################
+
+/**
+ * @brief Electronic gear and cam of one follower axis on a master axis, for cyclic synchronous position mode.
+ * Each update() reads master value.posActStep of the current cycle and writes follower TargetPosition in the same cycle.
+ * @note - Gear: follower moves master travel * NUM / DEN in exact integer arithmetic. Remainder is kept, so
+ * follower never drifts from master over any travel. Ratio can change in motion without position jump.
+ * @note - Cam: follower position is interpolated from a table of points at equal master spacing over one master period.
+ * Table can be replaced in motion; new table takes effect at the next master period boundary without jump.
+ * @note - Phase shift: an offset in master pulses is added to master position. It moves to its target with
+ * PHASE_VELOCITY and PHASE_ACCELERATION limits while master and follower keep running.
+ * @note - setRatio(), loadCam(), shiftPhase() and stop() are lock-free and can be called from one non real-time thread.
+ * @note - Use one object for each follower. Master can be shared by many objects.
+ */
+class L7NHGear
+{
+public:
+
+    /// @brief Coupling modes.
+    enum Mode
+    {
+        MODE_NONE = 0,                  ///< Follower is not written.
+        MODE_GEAR,
+        MODE_CAM
+    };
+
+    /// @brief Parameters structure.
+    struct ParameterStructure
+    {
+        /// @brief Cycle period of update(). [ns]
+        uint32_t PERIOD;
+
+        /// @brief Maximum velocity of phase shift. [master pulses/s]
+        float PHASE_VELOCITY;
+
+        /// @brief Maximum acceleration of phase shift. [master pulses/s^2]
+        float PHASE_ACCELERATION;
+
+        /// @brief Cam interpolation. 0: linear, 1: Catmull-Rom cubic spline.
+        uint8_t CAM_INTERPOLATION;
+    }parameters;
+
+    /// @brief Default constructor. Init parameters.
+    L7NHGear();
+
+    /**
+     * @brief Attach master and follower axes. Coupling is stopped.
+     * @return true if successed.
+     */
+    bool attach(L7NH *master, L7NH *follower);
+
+    /**
+     * @brief Couple follower by gear ratio num/den. It takes effect in the next update().
+     * @return false if den is zero.
+     * @note Follower starts from its current position, so coupling never makes a jump.
+     */
+    bool setRatio(int32_t num, uint32_t den);
+
+    /**
+     * @brief Load a cam table and couple follower by it.
+     * @param points are follower positions [pulses] at master phase k * period / count for k = 0 to count.
+     * So array size is count + 1. points[count] - points[0] is follower rise in each master period.
+     * @param period is master period. [pulses]
+     * @return false if table is not correct or the previous table is not taken by update() yet.
+     * @note Table is copied. If cam is running, it is changed at the next master period boundary.
+     */
+    bool loadCam(const int32_t *points, int count, uint32_t period);
+
+    /**
+     * @brief Add a phase shift to master position. [master pulses]
+     * Phase moves with PHASE_VELOCITY and PHASE_ACCELERATION limits.
+     */
+    void shiftPhase(int32_t shift);
+
+    /// @brief Stop coupling. Follower keeps its last TargetPosition.
+    void stop(void);
+
+    /**
+     * @brief Run one cycle of coupling and write follower TargetPosition in PDO mode.
+     * @return false if not attached or TargetPosition is not in RxPDO mapping of follower.
+     * @note Call it once per cycle from the cyclic thread after master value is updated. eg: in executor cycle callback.
+     */
+    bool update(void);
+
+    /// @brief Get coupling mode. It is safe to call from any thread.
+    Mode getMode(void);
+
+    /// @brief Get last commanded follower position. [pulses]
+    int32_t getFollowerPosition(void);
+
+    /// @brief Get current phase offset. [master pulses]
+    int64_t getPhase(void);
+
+    /// @brief true if phase is moving to its target. It is safe to call from any thread.
+    bool isPhaseShifting(void);
+
+private:
+
+    /// Cam table.
+    struct _Cam
+    {
+        int32_t points[L7NH_GEAR_MAX_CAM_POINTS + 1];
+        int32_t count;
+        uint32_t period;
+    }_cams[2];
+
+    L7NH *_master;
+
+    L7NH *_follower;
+
+    std::atomic<uint8_t> _mode;
+
+    // Requests from setRatio(), loadCam() and stop().
+    std::atomic<uint64_t> _ratioRequest;
+    std::atomic<bool> _ratioPending;
+    std::atomic<int8_t> _camPending;
+    std::atomic<bool> _stopPending;
+
+    /// Index of cam used by update().
+    std::atomic<uint8_t> _camActive;
+
+    /// true until first update() after attach.
+    bool _first;
+
+    int32_t _masterLast;
+
+    /// Unwrapped master position. [pulses]
+    int64_t _masterAbs;
+
+    int32_t _num;
+    uint32_t _den;
+
+    /// Follower position at origin of gear or cam. [pulses]
+    int64_t _origin;
+
+    /// Gear master travel that is not converted to origin. 0 <= _travel < _den.
+    int64_t _travel;
+
+    /// Master period number in last cam update.
+    int64_t _camPeriod;
+
+    /// Last commanded follower position. [pulses]
+    int64_t _output;
+
+    std::atomic<int64_t> _phaseTarget;
+    double _phase;
+    double _phaseVelocity;
+    int64_t _phaseRounded;
+    std::atomic<int64_t> _phaseOut;
+    std::atomic<bool> _shifting;
+
+    /// One cycle of phase ramp.
+    void _rampPhase(void);
+
+    /// Follower position of cam at a master phase. [pulses]
+    int64_t _camValue(const _Cam &cam, int64_t phase);
+
+    /// Follower cam point with periodic extension. k can be -1 to count + 1.
+    int64_t _camPoint(const _Cam &cam, int64_t k);
+};
+
+#endif
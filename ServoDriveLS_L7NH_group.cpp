@@ -0,0 +1,250 @@
+#include "ServoDriveLS_L7NH_group.h"
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+L7NHGroup::L7NHGroup()
+{
+    _axisCount = 0;
+
+    for(int i = 0; i < L7NHGROUP_MAX_AXES; i++)
+    {
+        _axes[i] = nullptr;
+        _posGain[i] = 0;
+        _velGain[i] = 0;
+        _trqGain[i] = 0;
+    }
+
+    memset(&value, 0, sizeof(value));
+
+    _lastError.store(ERROR_NONE);
+}
+
+L7NHGroup::ErrorCode L7NHGroup::getLastError(void)
+{
+    return (ErrorCode)_lastError.load(std::memory_order_relaxed);
+}
+
+void L7NHGroup::clearError(void)
+{
+    _lastError.store(ERROR_NONE, std::memory_order_relaxed);
+}
+
+const char* L7NHGroup::getErrorDescription(ErrorCode code)
+{
+    static const char* const descriptions[] =
+    {
+        "No error.",
+        "Error L7NHGroup: Process image of one or some axes is not bound."
+    };
+
+    static_assert(sizeof(descriptions) / sizeof(descriptions[0]) == ERROR_NUM, "Description table does not match ErrorCode.");
+
+    if( (code < 0) || (code >= ERROR_NUM) )
+    {
+        return "Error L7NHGroup: Unknown error code.";
+    }
+
+    return descriptions[code];
+}
+
+void L7NHGroup::_setError(ErrorCode code, int32_t slave)
+{
+    if(_lastError.exchange(code, std::memory_order_relaxed) != code)
+    {
+        L7NHLog::push(slave, code, getErrorDescription(code));
+    }
+}
+
+bool L7NHGroup::addAxis(L7NH *axis)
+{
+    if(axis == nullptr)
+    {
+        errorMessage = "Error L7NHGroup: Axis pointer is null.";
+        return false;
+    }
+
+    if(_axisCount >= L7NHGROUP_MAX_AXES)
+    {
+        errorMessage = "Error L7NHGroup: Number of axes is more than L7NHGROUP_MAX_AXES.";
+        return false;
+    }
+
+    _axes[_axisCount] = axis;
+    _axisCount++;
+
+    updateGains();
+
+    return true;
+}
+
+int L7NHGroup::getAxisCount(void)
+{
+    return _axisCount;
+}
+
+L7NH* L7NHGroup::getAxis(int index)
+{
+    if( (index < 0) || (index >= _axisCount) )
+    {
+        return nullptr;
+    }
+
+    return _axes[index];
+}
+
+void L7NHGroup::updateGains(void)
+{
+    for(int i = 0; i < _axisCount; i++)
+    {
+        _posGain[i] = _axes[i]->getPositionGain();
+        _velGain[i] = _axes[i]->getVelocityGain();
+        _trqGain[i] = _axes[i]->getTorqueGain();
+    }
+}
+
+bool L7NHGroup::updateValuesPDO(void)
+{
+    int32_t unboundSlave = -1;
+
+    // Gather raw feedback of all axes from process image.
+    for(int i = 0; i < _axisCount; i++)
+    {
+        const L7NH *axis = _axes[i];
+
+        int32_t position;
+        int32_t velocity;
+        int16_t torque;
+        uint16_t statusWord;
+        int8_t modeDisplay;
+        uint32_t digitalInputs;
+
+        if( (axis->_pdoBound == false) && (unboundSlave < 0) )
+        {
+            unboundSlave = axis->parameters.ETHERCAT_ID;
+        }
+
+        // Unbound and unmapped objects read zero.
+        memcpy(&statusWord, axis->_txPtr[0], 2);
+        memcpy(&position, axis->_txPtr[2], 4);
+        memcpy(&velocity, axis->_txPtr[3], 4);
+        memcpy(&torque, axis->_txPtr[4], 2);
+        memcpy(&digitalInputs, axis->_txPtr[10], 4);
+        memcpy(&modeDisplay, axis->_txPtr[11], 1);
+
+        value.posActStep[i] = position;
+        value.velActStep[i] = velocity;
+        value.trqActStep[i] = torque;
+        value.statusWord[i] = statusWord;
+        value.controlMode[i] = modeDisplay;
+        value.digitalInputs[i] = (uint8_t)(digitalInputs >> 16);
+    }
+
+    // Convert all axes to user units together. Padding cells have zero gain.
+    int num = (_axisCount + 7) & ~7;
+
+    _convert(value.posActStep, _posGain, value.posActDeg, num);
+    _convert(value.velActStep, _velGain, value.velAct, num);
+    _convert(value.trqActStep, _trqGain, value.trqActNm, num);
+
+    if(unboundSlave >= 0)
+    {
+        _setError(ERROR_PDO_NOT_BOUND, unboundSlave);
+        return false;
+    }
+
+    return true;
+}
+
+bool L7NHGroup::saveParams(uint8_t subindex)
+{
+    return _eepromAll(false, subindex);
+}
+
+bool L7NHGroup::loadParams(uint8_t subindex)
+{
+    return _eepromAll(true, subindex);
+}
+
+bool L7NHGroup::_eepromAll(bool restore, uint8_t subindex)
+{
+    std::thread threads[L7NHGROUP_MAX_AXES];
+    bool results[L7NHGROUP_MAX_AXES];
+    int started = 0;
+
+    // Send the command to all axes together. Each thread holds only the SDO lock of its own slave.
+    for(; started < _axisCount; started++)
+    {
+        results[started] = false;
+
+        try
+        {
+            threads[started] = std::thread(&L7NHGroup::_eepromAxis, this, started, restore, subindex, &results[started]);
+        }
+        catch(const std::system_error &)
+        {
+            break;
+        }
+    }
+
+    // Never return while a command is pending.
+    for(int i = 0; i < started; i++)
+    {
+        threads[i].join();
+    }
+
+    int failedAxis = -1;
+
+    for(int i = 0; i < _axisCount; i++)
+    {
+        if( (i >= started) || (results[i] == false) )
+        {
+            failedAxis = i;
+            break;
+        }
+    }
+
+    if(failedAxis >= 0)
+    {
+        errorMessage = "Error L7NHGroup: EEPROM store/restore of axis " + std::to_string(failedAxis) + " was not successed.";
+        return false;
+    }
+
+    return true;
+}
+
+void L7NHGroup::_eepromAxis(int axis, bool restore, uint8_t subindex, bool *result)
+{
+    if(restore)
+        *result = _axes[axis]->_eepromBlocking(Index_RestoreDefaultParameters, subindex, LOAD);
+    else
+        *result = _axes[axis]->_eepromBlocking(Index_StoreParameters, subindex, SAVE);
+}
+
+void L7NHGroup::_convert(const int32_t *in, const float *gain, float *out, int num)
+{
+    int i = 0;
+
+#if defined(__AVX2__)
+    for(; i + 8 <= num; i += 8)
+    {
+        __m256 data = _mm256_cvtepi32_ps(_mm256_load_si256((const __m256i *)(in + i)));
+        _mm256_store_ps(out + i, _mm256_mul_ps(data, _mm256_load_ps(gain + i)));
+    }
+#elif defined(__ARM_NEON)
+    for(; i + 4 <= num; i += 4)
+    {
+        float32x4_t data = vcvtq_f32_s32(vld1q_s32(in + i));
+        vst1q_f32(out + i, vmulq_f32(data, vld1q_f32(gain + i)));
+    }
+#endif
+
+    // Scalar fallback.
+    for(; i < num; i++)
+    {
+        out[i] = (float)in[i] * gain[i];
+    }
+}
@@ -0,0 +1,150 @@
+#ifndef L7NH_GROUP_H
+#define L7NH_GROUP_H
+
+// Header Includes:
+#include <thread>                           // For parallel EEPROM commands
+#include <system_error>                     // Thread creation failure
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+
+// ####################################################
+// Macros:
+
+// Maximum number of axes in one group. Must be a multiple of 8.
+#define L7NHGROUP_MAX_AXES              64
+
+// ####################################################
+
+/**
+ * @brief Group of L7NH axes on one bus.
+ * Feedback of all axes is kept in structure-of-arrays form and converted to user units by
+ * vectorized kernels (AVX2 or NEON if the compiler targets them, otherwise scalar).
+ */
+class L7NHGroup
+{
+public:
+
+    /// @brief Error codes of cyclic functions. Description of each code is given by getErrorDescription().
+    enum ErrorCode
+    {
+        ERROR_NONE = 0,
+        ERROR_PDO_NOT_BOUND,
+        ERROR_NUM                       ///< Number of error codes.
+    };
+
+    /**
+     * @brief Last error message accured for object.
+     * @note Only setup functions (addAxis(), saveParams(), loadParams()) set it. updateValuesPDO() reports by
+     * error code, because it runs in the cyclic thread.
+     */
+    std::string errorMessage;
+
+    /**
+     * @brief Values structure. Structure of arrays, index i is the i'th added axis.
+     * @note Cells from axis count up to L7NHGROUP_MAX_AXES are kept zero.
+     */
+    struct ValuesStructure
+    {
+        alignas(32) int32_t posActStep[L7NHGROUP_MAX_AXES];     ///< Raw Actual position. [pulses]
+        alignas(32) int32_t velActStep[L7NHGROUP_MAX_AXES];     ///< Raw Actual velocity. [pulses/sec]
+        alignas(32) int32_t trqActStep[L7NHGROUP_MAX_AXES];     ///< Raw Actual torque. [0.1% of nominal torque]
+        alignas(32) float posActDeg[L7NHGROUP_MAX_AXES];        ///< Actual position. [deg]
+        alignas(32) float velAct[L7NHGROUP_MAX_AXES];           ///< Actual velocity. [SPD_UNIT]
+        alignas(32) float trqActNm[L7NHGROUP_MAX_AXES];         ///< Actual torque. [TORQUE_RATED unit]
+        uint16_t statusWord[L7NHGROUP_MAX_AXES];                ///< Statusword register value.
+        int8_t controlMode[L7NHGROUP_MAX_AXES];                 ///< Operation mode display.
+        uint8_t digitalInputs[L7NHGROUP_MAX_AXES];              ///< Digital inputs. bit 0 is channel 1.
+    }value;
+
+    /// @brief Default constructor. Init values.
+    L7NHGroup();
+
+    /**
+     * @brief Add an axis to group.
+     * @return true if successed.
+     * @note - Use it after axis init(), when encoder pulse per revolution is known.
+     */
+    bool addAxis(L7NH *axis);
+
+    /// @brief Get last error code of cyclic functions. It is lock-free and safe to call from any thread.
+    ErrorCode getLastError(void);
+
+    /// @brief Set last error code to ERROR_NONE.
+    void clearError(void);
+
+    /// @brief Get static description string of an error code.
+    static const char* getErrorDescription(ErrorCode code);
+
+    /// @brief Get number of axes in group.
+    int getAxisCount(void);
+
+    /// @brief Get pointer of axis with certain index in group. nullptr if not exist.
+    L7NH* getAxis(int index);
+
+    /**
+     * @brief Recalculate unit conversion gains of all axes.
+     * @note Use it if parameters like GEAR_RATIO or TORQUE_RATED of axes changed after addAxis().
+     */
+    void updateGains(void);
+
+    /**
+     * @brief Read feedback of all axes from process image and convert them to user units.
+     * @return true if successed. false if one axis is not bound by L7NH::bindPDO().
+     * @note It never allocates, blocks or makes a system call. Errors are reported by getLastError() and L7NHLog.
+     */
+    bool updateValuesPDO(void);
+
+    /**
+     * @brief Save a parameter group in EEPROM memory of all axes together.
+     * One short-lived thread per axis sends the store command and waits for its response. SDO locks are per
+     * slave, so all drives write EEPROM at the same time and total time is about the slowest drive.
+     * @param subindex is SubIndex_StoreParameters... macro. eg: SubIndex_StoreParametersAll
+     * @return true if all axes reported completion before their EEPROM_DEADLINE.
+     * @note - EEPROM_DEADLINE of each axis starts when its own command is sent.
+     * @note - No mailbox worker is needed. If a thread can not be created, the axes left are not started
+     * and reported as failed. It returns only after every started command finished.
+     * @warning It blocks until all axes finished. Do not use it in the cyclic thread.
+     */
+    bool saveParams(uint8_t subindex);
+
+    /**
+     * @brief Restore default values of a parameter group in all axes together.
+     * @param subindex is SubIndex_RestoreDefaultParameters... macro. eg: SubIndex_RestoreDefaultParametersAll
+     * @return true if all axes reported completion before their EEPROM_DEADLINE.
+     * @warning It blocks like saveParams().
+     */
+    bool loadParams(uint8_t subindex);
+
+private:
+
+    L7NH *_axes[L7NHGROUP_MAX_AXES];
+
+    int _axisCount;
+
+    /// Last error code.
+    std::atomic<uint16_t> _lastError;
+
+    // Unit conversion gains for each axis.
+    alignas(32) float _posGain[L7NHGROUP_MAX_AXES];
+    alignas(32) float _velGain[L7NHGROUP_MAX_AXES];
+    alignas(32) float _trqGain[L7NHGROUP_MAX_AXES];
+
+    /**
+     * @brief out[i] = in[i] * gain[i] for i in range 0 to num.
+     * @note All arrays must be 32 bytes aligned and num multiple of 8.
+     */
+    static void _convert(const int32_t *in, const float *gain, float *out, int num);
+
+    /**
+     * @brief Set last error code and push it in deferred log.
+     * @note Log entry is pushed only when the code changes, so an error repeated every cycle does not fill the log.
+     */
+    void _setError(ErrorCode code, int32_t slave);
+
+    /// Run store/restore of all axes on parallel threads and join them.
+    bool _eepromAll(bool restore, uint8_t subindex);
+
+    /// Thread body of one axis in _eepromAll().
+    void _eepromAxis(int axis, bool restore, uint8_t subindex, bool *result);
+};
+
+#endif
@@ -0,0 +1,182 @@
+// L7NH Driver latency histogram Header File:
+
+#ifndef _L7NH_HISTOGRAM_H
+#define _L7NH_HISTOGRAM_H
+
+// Header Includes:
+#include <stdint.h>                 // fixed width integer types
+#include <atomic>                   // atomic operations
+
+// ####################################################
+
+namespace _L7NH
+{
+    /**
+     * @brief Lock-free latency histogram with log2 buckets split into linear sub-buckets (HDR style).
+     * Values below SUB_BUCKETS have their own bucket. Each power of two range above is split into SUB_BUCKETS
+     * equal buckets, so bucket width is at most 1/SUB_BUCKETS of the value.
+     * @note record() can be called from many threads and never allocates, blocks or makes syscalls.
+     * Query functions can be called from any thread. Results are approximate while recording is running.
+     * @note Percentiles are upper bound of their bucket, limited to recorded min and max.
+     */
+    class LatencyHistogram
+    {
+    public:
+
+        /// log2 of SUB_BUCKETS.
+        static constexpr int SUB_BITS = 3;
+
+        /// Linear sub-buckets in each power of two range.
+        static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+
+        /// Number of buckets. Exact buckets of small values, then SUB_BUCKETS for each msb position of 32 bits.
+        static constexpr int BUCKETS = SUB_BUCKETS + (32 - SUB_BITS) * SUB_BUCKETS;
+
+        LatencyHistogram()
+        {
+            reset();
+        }
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        /// Record one value.
+        void record(uint32_t value)
+        {
+            _buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+            _count.fetch_add(1, std::memory_order_relaxed);
+
+            uint32_t old = _min.load(std::memory_order_relaxed);
+            while( (value < old) && !_min.compare_exchange_weak(old, value, std::memory_order_relaxed) );
+
+            old = _max.load(std::memory_order_relaxed);
+            while( (value > old) && !_max.compare_exchange_weak(old, value, std::memory_order_relaxed) );
+        }
+
+        /// Number of recorded values.
+        uint64_t count(void) const
+        {
+            return _count.load(std::memory_order_relaxed);
+        }
+
+        /// Minimum recorded value. 0 if nothing recorded.
+        uint32_t min(void) const
+        {
+            return (count() == 0) ? 0 : _min.load(std::memory_order_relaxed);
+        }
+
+        /// Maximum recorded value. 0 if nothing recorded.
+        uint32_t max(void) const
+        {
+            return _max.load(std::memory_order_relaxed);
+        }
+
+        /// Bucket index of a value.
+        static int index(uint32_t value)
+        {
+            if(value < (uint32_t)SUB_BUCKETS)
+            {
+                return (int)value;
+            }
+
+            // Top SUB_BITS bits under the msb select the sub-bucket.
+            int shift = (31 - __builtin_clz(value)) - SUB_BITS;
+
+            return SUB_BUCKETS + shift * SUB_BUCKETS + (int)((value >> shift) & (SUB_BUCKETS - 1));
+        }
+
+        /// Largest value of a bucket.
+        static uint32_t upperBound(int index)
+        {
+            if(index < SUB_BUCKETS)
+            {
+                return (index < 0) ? 0 : (uint32_t)index;
+            }
+
+            int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+            uint64_t lower = (uint64_t)(SUB_BUCKETS + (index - SUB_BUCKETS) % SUB_BUCKETS) << shift;
+
+            return (uint32_t)(lower + (1ULL << shift) - 1);
+        }
+
+        /// Number of values in a bucket.
+        uint64_t bucket(int index) const
+        {
+            if( (index < 0) || (index >= BUCKETS) )
+            {
+                return 0;
+            }
+
+            return _buckets[index].load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Get approximate percentile value.
+         * @param percent is in range 0 to 100. eg: 50 for median, 99 for p99.
+         * @return 0 if nothing recorded.
+         */
+        uint32_t percentile(double percent) const
+        {
+            uint64_t total = count();
+
+            if(total == 0)
+            {
+                return 0;
+            }
+
+            uint64_t rank = (uint64_t)(percent / 100.0 * (double)total + 0.5);
+            if(rank < 1)
+            {
+                rank = 1;
+            }
+
+            uint64_t sum = 0;
+            uint32_t value = max();
+
+            for(int i = 0; i < BUCKETS; i++)
+            {
+                sum += _buckets[i].load(std::memory_order_relaxed);
+
+                if(sum >= rank)
+                {
+                    value = upperBound(i);
+                    break;
+                }
+            }
+
+            if(value > max())
+            {
+                value = max();
+            }
+
+            if(value < min())
+            {
+                value = min();
+            }
+
+            return value;
+        }
+
+        /// Clear all recorded values.
+        void reset(void)
+        {
+            for(int i = 0; i < BUCKETS; i++)
+            {
+                _buckets[i].store(0, std::memory_order_relaxed);
+            }
+
+            _count.store(0, std::memory_order_relaxed);
+            _min.store(UINT32_MAX, std::memory_order_relaxed);
+            _max.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+
+        std::atomic<uint64_t> _buckets[BUCKETS];
+        std::atomic<uint64_t> _count;
+        std::atomic<uint32_t> _min;
+        std::atomic<uint32_t> _max;
+    };
+}
+
+#endif
@@ -0,0 +1,277 @@
+#include "ServoDriveLS_L7NH_homing.h"
+
+// Controlword bit 4: homing operation start.
+#define L7NH_CONTROLWORD_HOMING_START   0x0010
+
+// Statusword bits of homing mode.
+#define L7NH_STATUSWORD_TARGET_REACHED  0x0400
+#define L7NH_STATUSWORD_HOMING_ATTAINED 0x1000
+#define L7NH_STATUSWORD_HOMING_ERROR    0x2000
+
+// Statusword mask and value of operation enabled state.
+#define L7NH_STATUSWORD_STATE_MASK      0x006F
+#define L7NH_STATUSWORD_OPERATION_ENABLED 0x0027
+
+L7NHHoming::L7NHHoming()
+{
+    parameters.METHOD = 34;
+    parameters.SPEED_SWITCH = 0;
+    parameters.SPEED_ZERO = 0;
+    parameters.OFFSET = 0;
+    parameters.TIMEOUT_CYCLES = 0;
+    parameters.RETURN_MODE = 0;
+
+    _axis = nullptr;
+    _callback = nullptr;
+    _user = nullptr;
+    _startRequest.store(false);
+    _abortRequest.store(false);
+    _state.store(HOMING_IDLE);
+    _cycles.store(0);
+}
+
+bool L7NHHoming::attach(L7NH *axis)
+{
+    if(axis == nullptr)
+    {
+        return false;
+    }
+
+    if( (axis->_TxMapFlag[0] == 0) || (axis->_RxMapFlag[0] == 0) || (axis->_RxMapFlag[5] == 0) )
+    {
+        return false;
+    }
+
+    _axis = axis;
+    _state.store(HOMING_IDLE);
+
+    return true;
+}
+
+bool L7NHHoming::configure(void)
+{
+    if(_axis == nullptr)
+    {
+        return false;
+    }
+
+    bool state = true;
+
+    state = _axis->write<_L7NH::Obj::HomingMethod>(parameters.METHOD) && state;
+    state = _axis->write<_L7NH::Obj::HomingSpeeds_Switch>(parameters.SPEED_SWITCH) && state;
+    state = _axis->write<_L7NH::Obj::HomingSpeeds_Zero>(parameters.SPEED_ZERO) && state;
+    state = _axis->write<_L7NH::Obj::HomeOffset>(parameters.OFFSET) && state;
+
+    return state;
+}
+
+bool L7NHHoming::start(L7NHHomingCallback callback, void *user)
+{
+    if( (_axis == nullptr) || isBusy() )
+    {
+        return false;
+    }
+
+    _callback = callback;
+    _user = user;
+    _abortRequest.store(false, std::memory_order_relaxed);
+    _startRequest.store(true, std::memory_order_release);
+
+    return true;
+}
+
+void L7NHHoming::abort(void)
+{
+    _abortRequest.store(true, std::memory_order_release);
+}
+
+bool L7NHHoming::update(void)
+{
+    if(_axis == nullptr)
+    {
+        return false;
+    }
+
+    if( (_axis->_rxBound[0] == false) || (_axis->snapshot.size < _axis->TxMapOffset_StatusWord + 2) )
+    {
+        return false;
+    }
+
+    uint16_t status_word;
+    memcpy(&status_word, _axis->snapshot.raw + _axis->TxMapOffset_StatusWord, 2);
+
+    State state = (State)_state.load(std::memory_order_relaxed);
+
+    if(_abortRequest.exchange(false, std::memory_order_acquire))
+    {
+        _startRequest.store(false, std::memory_order_relaxed);
+
+        if( (state == HOMING_WAIT_MODE) || (state == HOMING_RUNNING) )
+        {
+            _finish(HOMING_ABORTED);
+        }
+
+        return true;
+    }
+
+    if(_startRequest.exchange(false, std::memory_order_acquire))
+    {
+        state = HOMING_WAIT_MODE;
+        _state.store(state, std::memory_order_relaxed);
+        _cycles.store(0, std::memory_order_relaxed);
+    }
+
+    if( (state != HOMING_WAIT_MODE) && (state != HOMING_RUNNING) )
+    {
+        return true;
+    }
+
+    uint32_t cycles = _cycles.load(std::memory_order_relaxed);
+    bool enabled = ( (status_word & L7NH_STATUSWORD_STATE_MASK) == L7NH_STATUSWORD_OPERATION_ENABLED );
+
+    if(state == HOMING_WAIT_MODE)
+    {
+        _axis->setModesOfOperationPDO(OPERATION_MODE_HM);
+
+        bool mode = true;
+
+        if( (_axis->_TxMapFlag[11] != 0) && (_axis->snapshot.size >= _axis->TxMapOffset_OperationModeDisplay + 1) )
+        {
+            int8_t display;
+            memcpy(&display, _axis->snapshot.raw + _axis->TxMapOffset_OperationModeDisplay, 1);
+            mode = (display == OPERATION_MODE_HM);
+        }
+
+        // Bit 4 is kept low for at least one cycle, so the next set is a rising edge.
+        if( enabled && mode && (cycles > 0) )
+        {
+            _writeBit4(true);
+            _state.store(HOMING_RUNNING, std::memory_order_relaxed);
+            _cycles.store(0, std::memory_order_relaxed);
+            return true;
+        }
+
+        _writeBit4(false);
+    }
+    else
+    {
+        _writeBit4(true);
+
+        if(enabled == false)
+        {
+            _finish(HOMING_ERROR);
+            return true;
+        }
+
+        if(cycles >= _START_CYCLES)
+        {
+            if(status_word & L7NH_STATUSWORD_HOMING_ERROR)
+            {
+                _finish(HOMING_ERROR);
+                return true;
+            }
+
+            uint16_t done = L7NH_STATUSWORD_HOMING_ATTAINED | L7NH_STATUSWORD_TARGET_REACHED;
+
+            if( (status_word & done) == done )
+            {
+                _finish(HOMING_ATTAINED);
+                return true;
+            }
+        }
+    }
+
+    if( (parameters.TIMEOUT_CYCLES != 0) && (cycles >= parameters.TIMEOUT_CYCLES) )
+    {
+        _finish(HOMING_TIMEOUT);
+        return true;
+    }
+
+    _cycles.store(cycles + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+L7NHHoming::State L7NHHoming::getState(void)
+{
+    return (State)_state.load(std::memory_order_relaxed);
+}
+
+bool L7NHHoming::isBusy(void)
+{
+    if(_startRequest.load(std::memory_order_relaxed))
+    {
+        return true;
+    }
+
+    uint8_t state = _state.load(std::memory_order_relaxed);
+
+    return ( (state == HOMING_WAIT_MODE) || (state == HOMING_RUNNING) );
+}
+
+uint32_t L7NHHoming::getCycles(void)
+{
+    return _cycles.load(std::memory_order_relaxed);
+}
+
+const char* L7NHHoming::getStateName(State state)
+{
+    switch(state)
+    {
+        case HOMING_IDLE:
+            return "Idle";
+        case HOMING_WAIT_MODE:
+            return "Wait mode";
+        case HOMING_RUNNING:
+            return "Running";
+        case HOMING_ATTAINED:
+            return "Attained";
+        case HOMING_ERROR:
+            return "Error";
+        case HOMING_TIMEOUT:
+            return "Timeout";
+        case HOMING_ABORTED:
+            return "Aborted";
+    }
+
+    return "Unknown";
+}
+
+void L7NHHoming::_finish(State state)
+{
+    _writeBit4(false);
+
+    if(parameters.RETURN_MODE != 0)
+    {
+        if(_axis->_RxMapFlag[1] != 0)
+        {
+            _axis->setTargetPositionPDO(_axis->value.posActStep);
+        }
+
+        _axis->setModesOfOperationPDO(parameters.RETURN_MODE);
+    }
+
+    _state.store(state, std::memory_order_relaxed);
+
+    if(_callback != nullptr)
+    {
+        _callback(*this, state, _user);
+    }
+}
+
+void L7NHHoming::_writeBit4(bool set)
+{
+    uint16_t control_word;
+    memcpy(&control_word, _axis->_rxPtr[0], 2);
+
+    if(set)
+    {
+        control_word |= L7NH_CONTROLWORD_HOMING_START;
+    }
+    else
+    {
+        control_word &= ~L7NH_CONTROLWORD_HOMING_START;
+    }
+
+    memcpy(_axis->_rxPtr[0], &control_word, 2);
+}
@@ -0,0 +1,147 @@
+#ifndef L7NH_HOMING_H
+#define L7NH_HOMING_H
+
+// Header Includes:
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+
+// ####################################################
+
+class L7NHHoming;
+
+/**
+ * @brief Completion callback of homing.
+ * @param state is L7NHHoming::State value. eg: HOMING_ATTAINED
+ * @note It runs inside update() on the cyclic thread. Keep it short and do not block in it.
+ */
+typedef void (*L7NHHomingCallback)(L7NHHoming &homing, int state, void *user);
+
+/**
+ * @brief Non-blocking homing engine of one axis driven from process data.
+ * Homing objects are written once by configure() in SDO mode. Then update() runs homing from the cyclic
+ * process data: it writes ModesOfOperation = HM, gives a rising edge on controlword bit 4 and watches
+ * statusword bits 10 (target reached), 12 (homing attained) and 13 (homing error).
+ * @note - Statusword must exist in TxPDO, controlword and ModesOfOperation in RxPDO mapping.
+ * OperationModeDisplay in TxPDO is optional. If it exists, homing starts after drive displays HM mode.
+ * @note - Drive must be in operation enabled state. eg: by L7NHStateMachine. Only controlword bit 4 is written,
+ * so it works together with a state machine of the same axis.
+ * @note - Use one engine for each axis and update them in the same cycle to home many axes at once.
+ * @note - start() and abort() are lock-free and can be called from any thread.
+ */
+class L7NHHoming
+{
+public:
+
+    /// @brief Homing states.
+    enum State
+    {
+        HOMING_IDLE = 0,                ///< Not started.
+        HOMING_WAIT_MODE,               ///< Waiting for HM mode and operation enabled state.
+        HOMING_RUNNING,                 ///< Controlword bit 4 is set and drive is homing.
+        HOMING_ATTAINED,                ///< Homing is completed successfully.
+        HOMING_ERROR,                   ///< Drive reported homing error or left operation enabled state.
+        HOMING_TIMEOUT,                 ///< TIMEOUT_CYCLES expired.
+        HOMING_ABORTED                  ///< Stopped by abort().
+    };
+
+    /// @brief Parameters structure.
+    struct ParameterStructure
+    {
+        /// @brief Homing method. See Index_HomingMethod. eg: 34 for homing to the index pulse.
+        int8_t METHOD;
+
+        /// @brief Speed during search for switch. [UU/s]
+        uint32_t SPEED_SWITCH;
+
+        /// @brief Speed during search for zero. [UU/s]
+        uint32_t SPEED_ZERO;
+
+        /// @brief Home offset. [UU]
+        int32_t OFFSET;
+
+        /**
+         * @brief Maximum number of update() cycles for homing. 0 means no timeout.
+         * @note eg: 30000 for 30 seconds at 1 kHz cycle.
+         */
+        uint32_t TIMEOUT_CYCLES;
+
+        /**
+         * @brief Mode of operation that is written after homing is finished. 0 keeps HM mode.
+         * @note If TargetPosition is in RxPDO, it is set to actual position first, so a position mode starts without jump.
+         */
+        int8_t RETURN_MODE;
+    }parameters;
+
+    /// @brief Default constructor. Init parameters.
+    L7NHHoming();
+
+    /**
+     * @brief Attach homing engine to an axis.
+     * @return true if successed.
+     * @note Use it after the axis PDO mapping is configured.
+     * @note update() runs only after the axis is bound by L7NH::bindPDO(), eg: by L7NHExecutor::start().
+     */
+    bool attach(L7NH *axis);
+
+    /**
+     * @brief Write METHOD, SPEED_SWITCH, SPEED_ZERO and OFFSET in drive in SDO mode.
+     * @return true if successed.
+     * @note It blocks on SDO. Do not use it in the cyclic thread.
+     */
+    bool configure(void);
+
+    /**
+     * @brief Request homing start. It is taken by the next update().
+     * @param callback is optional completion callback.
+     * @return false if not attached or homing is running.
+     */
+    bool start(L7NHHomingCallback callback = nullptr, void *user = nullptr);
+
+    /// @brief Request homing stop. Controlword bit 4 is cleared in the next update().
+    void abort(void);
+
+    /**
+     * @brief Run one cycle of homing. Call it from the cyclic thread between receive and send of process data.
+     * @note The axis snapshot must be taken in this cycle. eg: by axis->updateValuesPDO()
+     * @return false if not attached or required objects are not mapped.
+     */
+    bool update(void);
+
+    /// @brief Get homing state. It is safe to call from any thread.
+    State getState(void);
+
+    /// @brief true if homing is requested or running.
+    bool isBusy(void);
+
+    /// @brief Get number of update() cycles since homing started.
+    uint32_t getCycles(void);
+
+    /// @brief Get name string of a state.
+    static const char* getStateName(State state);
+
+private:
+
+    L7NH *_axis;
+
+    L7NHHomingCallback _callback;
+
+    void *_user;
+
+    std::atomic<bool> _startRequest;
+
+    std::atomic<bool> _abortRequest;
+
+    std::atomic<uint8_t> _state;
+
+    std::atomic<uint32_t> _cycles;
+
+    /// Cycles of running state before completion bits are accepted. Statusword of previous homing can still be in
+    /// the first received frames after the rising edge.
+    static constexpr uint32_t _START_CYCLES = 4;
+
+    /// Clear controlword bit 4, restore mode and call callback.
+    void _finish(State state);
+
+    void _writeBit4(bool set);
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include "ServoDriveLS_L7NH_log.h"
+#include <time.h>                           // clock_gettime
+
+_L7NH::MpmcQueue<L7NHLogEntry, L7NH_LOG_CAPACITY> L7NHLog::_queue;
+
+std::atomic<bool> L7NHLog::_enable(true);
+
+std::atomic<uint64_t> L7NHLog::_drops(0);
+
+bool L7NHLog::push(int32_t slave, uint16_t code, const char *text)
+{
+    if(_enable.load(std::memory_order_relaxed) == false)
+    {
+        return false;
+    }
+
+    L7NHLogEntry entry;
+    struct timespec ts;
+
+    // CLOCK_MONOTONIC is served by vDSO without a syscall.
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    entry.time = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    entry.slave = slave;
+    entry.code = code;
+    entry.text = text;
+
+    if(_queue.push(entry) == false)
+    {
+        _drops.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+bool L7NHLog::pop(L7NHLogEntry &entry)
+{
+    return _queue.pop(entry);
+}
+
+int L7NHLog::flush(FILE *file)
+{
+    L7NHLogEntry entry;
+    int num = 0;
+
+    while(_queue.pop(entry))
+    {
+        fprintf(file, "[%lld.%09lld] slave %d, code %u: %s\n", (long long)(entry.time / 1000000000LL),
+                (long long)(entry.time % 1000000000LL), entry.slave, entry.code, (entry.text != nullptr) ? entry.text : "");
+        num++;
+    }
+
+    uint64_t drops = _drops.exchange(0, std::memory_order_relaxed);
+
+    if(drops > 0)
+    {
+        fprintf(file, "%lu log entries were dropped.\n", (unsigned long)drops);
+    }
+
+    fflush(file);
+
+    return num;
+}
+
+void L7NHLog::setEnable(bool enable)
+{
+    _enable.store(enable, std::memory_order_relaxed);
+}
+
+uint64_t L7NHLog::getDropCount(void)
+{
+    return _drops.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,71 @@
+#ifndef L7NH_LOG_H
+#define L7NH_LOG_H
+
+// Header Includes:
+#include <stdint.h>                         // fixed width integer types
+#include <stdio.h>                          // For flush to file
+#include <atomic>                           // atomic operations
+#include "ServoDriveLS_L7NH_queue.h"        // lock-free queue
+
+// ####################################################
+// Macros:
+
+// Number of preallocated entries of deferred log queue. Must be a power of 2.
+#define L7NH_LOG_CAPACITY               1024
+
+// ####################################################
+
+/// @brief Entry of deferred log.
+struct L7NHLogEntry
+{
+    int64_t time;                   ///< Entry time. CLOCK_MONOTONIC. [ns]
+    int32_t slave;                  ///< Ethercat slave id number of source. -1 if not related to a slave.
+    uint16_t code;                  ///< Error code. eg: L7NH::ErrorCode value.
+    const char *text;               ///< Static description string. It must live for whole program.
+};
+
+/**
+ * @brief Process wide deferred diagnostic log.
+ * Real-time code pushes fixed size entries into a preallocated lock-free queue without allocation,
+ * blocking or I/O. A non real-time thread prints them later by flush().
+ * @note If queue is full, new entries are dropped and counted.
+ */
+class L7NHLog
+{
+public:
+
+    /**
+     * @brief Push an entry. Time is taken from CLOCK_MONOTONIC.
+     * @param text must be a static string. eg: L7NH::getErrorDescription(code)
+     * @return false if log is disabled or queue is full.
+     */
+    static bool push(int32_t slave, uint16_t code, const char *text);
+
+    /**
+     * @brief Pop oldest entry.
+     * @return false if queue is empty.
+     */
+    static bool pop(L7NHLogEntry &entry);
+
+    /**
+     * @brief Print and remove all entries in file. Do not use it in real-time thread.
+     * @return number of printed entries.
+     */
+    static int flush(FILE *file);
+
+    /// @brief Enable or disable log. It is enabled by default.
+    static void setEnable(bool enable);
+
+    /// @brief Get number of dropped entries because queue was full. It is cleared by flush().
+    static uint64_t getDropCount(void);
+
+private:
+
+    static _L7NH::MpmcQueue<L7NHLogEntry, L7NH_LOG_CAPACITY> _queue;
+
+    static std::atomic<bool> _enable;
+
+    static std::atomic<uint64_t> _drops;
+};
+
+#endif
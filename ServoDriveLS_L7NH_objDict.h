@@ -23,6 +23,11 @@ namespace _L7NH
     #define FP32        7       // Float 32bit Single precision floating point
     #define STRING      8       // String Value
 
+    // Access rights of objects
+    #define Access_RO   0x01    // Read only
+    #define Access_WO   0x02    // Write only
+    #define Access_RW   0x03    // Read and write
+
     // StatusWord value for States machine
     #define StatusWord_NotReadyToSwitchOn               0x0000
     #define StatusWord_SwitchOnDisabled                 0x0040
@@ -566,6 +571,10 @@ Other               -           Reserved
 */
 #define Index_ModesOfOperation                  0x6060
 
+// Modes of Operation Display
+/*This displays the operation mode of the drive. It shows the same values as Modes of Operation (0x6060).*/
+#define Index_ModesOfOperationDisplay           0x6061
+
 // Target Position
 /*
 This specifies the target position in Profile Position (PP) mode and Cyclic Synchronous Position (CSP) mode.
@@ -626,6 +635,8 @@ Setting values      Details
 // Homing Speeds
 /*This specifies the operation speed for homing.*/
 #define Index_HomingSpeeds                      0x6099
+#define SubIndex_HomingSpeeds_Switch            1   // Speed during search for switch
+#define SubIndex_HomingSpeeds_Zero              2   // Speed during search for zero
 
 // Software Position Limit
 /*
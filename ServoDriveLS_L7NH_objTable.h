@@ -0,0 +1,202 @@
+// L7NH Driver Object Descriptor Table Header File:
+
+#ifndef _L7NH_OBJTABLE_H
+#define _L7NH_OBJTABLE_H
+
+// Header Includes:
+#include <stdint.h>                         // fixed width integer types
+#include "ServoDriveLS_L7NH_objDict.h"      // Object dictionary for L7NH drivers
+
+// ####################################################
+// Object table:
+
+/*
+Each line describes one object of the drive:
+X(Name, Index, SubIndex, DataType, Access, PdoMappable, Persist)
+- Name:         Type name in _L7NH::Obj namespace. eg: _L7NH::Obj::MotorID
+- DataType:     SINT/USINT/INT/UINT/DINT/UDINT/FP32. STRING objects are not listed.
+- Access:       Access_RO/Access_WO/Access_RW
+- PdoMappable:  true if object can be mapped in PDO.
+- Persist:      true if object is a configuration parameter that is kept in parameter snapshot file.
+Adding a new object only needs one line here.
+*/
+#define L7NH_OBJECT_TABLE(X) \
+    X(ErrorRegister,                        Index_ErrorRegister,                    0,                                                  USINT,  Access_RO,  false, false)  \
+    X(StoreParametersAll,                   Index_StoreParameters,                  SubIndex_StoreParametersAll,                        UDINT,  Access_RW,  false, false)  \
+    X(StoreParametersCommunication,         Index_StoreParameters,                  SubIndex_StoreParametersCommunication,              UDINT,  Access_RW,  false, false)  \
+    X(StoreParametersCiA402,                Index_StoreParameters,                  SubIndex_StoreParametersCiA402,                     UDINT,  Access_RW,  false, false)  \
+    X(StoreParametersSpecific,              Index_StoreParameters,                  SubIndex_StoreParametersSpecific,                   UDINT,  Access_RW,  false, false)  \
+    X(RestoreDefaultParametersAll,          Index_RestoreDefaultParameters,         SubIndex_RestoreDefaultParametersAll,               UDINT,  Access_RW,  false, false)  \
+    X(RestoreDefaultParametersCommunication,Index_RestoreDefaultParameters,         SubIndex_RestoreDefaultParametersCommunication,     UDINT,  Access_RW,  false, false)  \
+    X(RestoreDefaultParametersCiA402,       Index_RestoreDefaultParameters,         SubIndex_RestoreDefaultParametersCiA402,            UDINT,  Access_RW,  false, false)  \
+    X(RestoreDefaultParametersSpecific,     Index_RestoreDefaultParameters,         SubIndex_RestoreDefaultParametersSpecific,          UDINT,  Access_RW,  false, false)  \
+    X(MotorID,                              Index_MotorID,                          0,                                                  UINT,   Access_RW,  false, false)  \
+    X(EncoderType,                          Index_EncoderType,                      0,                                                  UINT,   Access_RW,  false, false)  \
+    X(EncoderPulsePerRevolution,            Index_EncoderPulsePerRevolution,        0,                                                  UDINT,  Access_RO,  false, false)  \
+    X(NodeID,                               Index_NodeID,                           0,                                                  UINT,   Access_RO,  false, false)  \
+    X(RotationDirectionSelect,              Index_RotationDirectionSelect,          0,                                                  UINT,   Access_RW,  false, true)   \
+    X(EncoderConfiguration,                 Index_EncoderConfiguration,             0,                                                  UINT,   Access_RW,  false, true)   \
+    X(UPhaseCurrentOffset,                  Index_UPhaseCurrentOffset,              0,                                                  INT,    Access_RW,  false, false)  \
+    X(VPhaseCurrentOffset,                  Index_VPhaseCurrentOffset,              0,                                                  INT,    Access_RW,  false, false)  \
+    X(WPhaseCurrentOffset,                  Index_WPhaseCurrentOffset,              0,                                                  INT,    Access_RW,  false, false)  \
+    X(InertiaRatio,                         Index_InertiaRatio,                     0,                                                  UINT,   Access_RW,  false, true)   \
+    X(TorqueLimitFunctionSelect,            Index_TorqueLimitFunctionSelect,        0,                                                  UINT,   Access_RW,  false, true)   \
+    X(ExternalPositiveTorqueLimitValue,     Index_ExternalPositiveTorqueLimitValue, 0,                                                  UINT,   Access_RW,  false, true)   \
+    X(ExternalNegativeTorqueLimitValue,     Index_ExternalNegativeTorqueLimitValue, 0,                                                  UINT,   Access_RW,  false, true)   \
+    X(InputSignalSelection_1,               Index_InputSignalSelection_1,           0,                                                  UINT,   Access_RW,  false, true)   \
+    X(InputSignalSelection_2,               Index_InputSignalSelection_2,           0,                                                  UINT,   Access_RW,  false, true)   \
+    X(InputSignalSelection_3,               Index_InputSignalSelection_3,           0,                                                  UINT,   Access_RW,  false, true)   \
+    X(InputSignalSelection_4,               Index_InputSignalSelection_4,           0,                                                  UINT,   Access_RW,  false, true)   \
+    X(InputSignalSelection_5,               Index_InputSignalSelection_5,           0,                                                  UINT,   Access_RW,  false, true)   \
+    X(InputSignalSelection_6,               Index_InputSignalSelection_6,           0,                                                  UINT,   Access_RW,  false, true)   \
+    X(InputSignalSelection_7,               Index_InputSignalSelection_7,           0,                                                  UINT,   Access_RW,  false, true)   \
+    X(InputSignalSelection_8,               Index_InputSignalSelection_8,           0,                                                  UINT,   Access_RW,  false, true)   \
+    X(DigitalOutputSignalSelection_1,       Index_DigitalOutputSignalSelection_1,   0,                                                  UINT,   Access_RW,  false, true)   \
+    X(DigitalOutputSignalSelection_2,       Index_DigitalOutputSignalSelection_2,   0,                                                  UINT,   Access_RW,  false, true)   \
+    X(DigitalOutputSignalSelection_3,       Index_DigitalOutputSignalSelection_3,   0,                                                  UINT,   Access_RW,  false, true)   \
+    X(DigitalOutputSignalSelection_4,       Index_DigitalOutputSignalSelection_4,   0,                                                  UINT,   Access_RW,  false, true)   \
+    X(JogOperationSpeed,                    Index_JogOperationSpeed,                0,                                                  INT,    Access_RW,  false, true)   \
+    X(SpeedCommandAccelerationTime,         Index_SpeedCommandAccelerationTime,     0,                                                  UINT,   Access_RW,  false, true)   \
+    X(SpeedCommandDecelerationTime,         Index_SpeedCommandDecelerationTime,     0,                                                  UINT,   Access_RW,  false, true)   \
+    X(SpeedCommandScurveTime,               Index_SpeedCommandScurveTime,           0,                                                  UINT,   Access_RW,  false, true)   \
+    X(SpeedLimitFunctionSelect,             Index_SpeedLimitFunctionSelect,         0,                                                  UINT,   Access_RW,  false, true)   \
+    X(SpeedLimitValueAtTorqueControlMode,   Index_SpeedLimitValueAtTorqueControlMode, 0,                                                UINT,   Access_RW,  false, true)   \
+    X(ServoLockFunctionSetting,             Index_ServoLockFunctionSetting,         0,                                                  UINT,   Access_RW,  false, true)   \
+    X(IndividualParameterStorage,           Index_IndividualParameterStorage,       0,                                                  UINT,   Access_RW,  false, false)  \
+    X(FeedbackSpeed,                        Index_FeedbackSpeed,                    0,                                                  INT,    Access_RO,  true,  false)  \
+    X(CommandSpeed,                         Index_CommandSpeed,                     0,                                                  INT,    Access_RO,  true,  false)  \
+    X(MechanicalAngle,                      Index_MechanicalAngle,                  0,                                                  UINT,   Access_RO,  true,  false)  \
+    X(ElectricalAngle,                      Index_ElectricalAngle,                  0,                                                  INT,    Access_RO,  true,  false)  \
+    X(DriveTemperature1,                    Index_DriveTemperature1,                0,                                                  INT,    Access_RO,  true,  false)  \
+    X(DriveTemperature2,                    Index_DriveTemperature2,                0,                                                  INT,    Access_RO,  true,  false)  \
+    X(EncoderTemperature,                   Index_EncoderTemperature,               0,                                                  INT,    Access_RO,  true,  false)  \
+    X(MotorRatedSpeed,                      Index_MotorRatedSpeed,                  0,                                                  UINT,   Access_RO,  false, false)  \
+    X(MotorMaximumSpeed,                    Index_MotorMaximumSpeed,                0,                                                  UINT,   Access_RO,  false, false)  \
+    X(WarningCode,                          Index_WarningCode,                      0,                                                  UINT,   Access_RO,  true,  false)  \
+    X(ProcedureCommandCode,                 Index_ProcedureCommandCode,             0,                                                  UINT,   Access_RW,  false, false)  \
+    X(ProcedureCommandArgument,             Index_ProcedureCommandArgument,         0,                                                  UINT,   Access_RW,  false, false)  \
+    X(ErrorCode,                            Index_ErrorCode,                        0,                                                  UINT,   Access_RO,  true,  false)  \
+    X(Controlword,                          Index_Controlword,                      0,                                                  UINT,   Access_RW,  true,  false)  \
+    X(Statusword,                           Index_Statusword,                       0,                                                  UINT,   Access_RO,  true,  false)  \
+    X(ModesOfOperation,                     Index_ModesOfOperation,                 0,                                                  SINT,   Access_RW,  true,  false)  \
+    X(ModesOfOperationDisplay,              Index_ModesOfOperationDisplay,          0,                                                  SINT,   Access_RO,  true,  false)  \
+    X(TargetPosition,                       Index_TargetPosition,                   0,                                                  DINT,   Access_RW,  true,  false)  \
+    X(PositionDemandInternalValue,          Index_PositionDemandInternalValue,      0,                                                  DINT,   Access_RO,  true,  false)  \
+    X(PositionDemandValue,                  Index_PositionDemandValue,              0,                                                  DINT,   Access_RO,  true,  false)  \
+    X(PositionActualInternalValue,          Index_PositionActualInternalValue,      0,                                                  DINT,   Access_RO,  true,  false)  \
+    X(PositionActualValue,                  Index_PositionActualValue,              0,                                                  DINT,   Access_RO,  true,  false)  \
+    X(HomeOffset,                           Index_HomeOffset,                       0,                                                  DINT,   Access_RW,  false, true)   \
+    X(HomingMethod,                         Index_HomingMethod,                     0,                                                  SINT,   Access_RW,  false, true)   \
+    X(HomingSpeeds_Switch,                  Index_HomingSpeeds,                     SubIndex_HomingSpeeds_Switch,                       UDINT,  Access_RW,  false, true)   \
+    X(HomingSpeeds_Zero,                    Index_HomingSpeeds,                     SubIndex_HomingSpeeds_Zero,                         UDINT,  Access_RW,  false, true)   \
+    X(SoftwarePositionLimit_Min,            Index_SoftwarePositionLimit,            SubIndex_SoftwarePositionLimit_Min,                 DINT,   Access_RW,  false, true)   \
+    X(SoftwarePositionLimit_Max,            Index_SoftwarePositionLimit,            SubIndex_SoftwarePositionLimit_Max,                 DINT,   Access_RW,  false, true)   \
+    X(VelocityDemandValue,                  Index_VelocityDemandValue,              0,                                                  DINT,   Access_RO,  true,  false)  \
+    X(VelocityActualValue,                  Index_VelocityActualValue,              0,                                                  DINT,   Access_RO,  true,  false)  \
+    X(TargetVelocity,                       Index_TargetVelocity,                   0,                                                  DINT,   Access_RW,  true,  false)  \
+    X(MaxProfileVelocity,                   Index_MaxProfileVelocity,               0,                                                  UDINT,  Access_RW,  true,  true)   \
+    X(ProfileVelocity,                      Index_ProfileVelocity,                  0,                                                  UDINT,  Access_RW,  true,  true)   \
+    X(ProfileAcceleration,                  Index_ProfileAcceleration,              0,                                                  UDINT,  Access_RW,  true,  true)   \
+    X(ProfileDeceleration,                  Index_ProfileDeceleration,              0,                                                  UDINT,  Access_RW,  true,  true)   \
+    X(TargetTorque,                         Index_TargetTorque,                     0,                                                  INT,    Access_RW,  true,  false)  \
+    X(MaximumTorque,                        Index_MaximumTorque,                    0,                                                  UINT,   Access_RW,  true,  true)   \
+    X(TorqueDemandValue,                    Index_TorqueDemandValue,                0,                                                  INT,    Access_RO,  true,  false)  \
+    X(TorqueActualValue,                    Index_TorqueActualValue,                0,                                                  INT,    Access_RO,  true,  false)  \
+    X(TorqueSlope,                          Index_TorqueSlope,                      0,                                                  UDINT,  Access_RW,  true,  true)   \
+    X(PositiveTorqueLimitValue,             Index_PositiveTorqueLimitValue,         0,                                                  UINT,   Access_RW,  true,  true)   \
+    X(NegativeTorqueLimitValue,             Index_NegativeTorqueLimitValue,         0,                                                  UINT,   Access_RW,  true,  true)   \
+    X(SupportedDriveModes,                  Index_SupportedDriveModes,              0,                                                  UDINT,  Access_RO,  false, false)  \
+    X(DigitalInputs,                        Index_DigitalInputs,                    0,                                                  UDINT,  Access_RO,  true,  false)  \
+    X(DigitalOutputs_Physicaloutputs,       Index_DigitalOutputs,                   SubIndex_DigitalOutputs_Physicaloutputs,            UDINT,  Access_RW,  true,  false)
+
+// ####################################################
+
+namespace _L7NH
+{
+    /// C type of each DataType code.
+    template<int DataTypeCode> struct ObjDataType;
+    template<> struct ObjDataType<SINT>  { typedef int8_t type; };
+    template<> struct ObjDataType<USINT> { typedef uint8_t type; };
+    template<> struct ObjDataType<INT>   { typedef int16_t type; };
+    template<> struct ObjDataType<UINT>  { typedef uint16_t type; };
+    template<> struct ObjDataType<DINT>  { typedef int32_t type; };
+    template<> struct ObjDataType<UDINT> { typedef uint32_t type; };
+    template<> struct ObjDataType<FP32>  { typedef float type; };
+
+    /**
+     * @brief Compile-time object type. Use it with L7NH::read<Obj>() and L7NH::write<Obj>().
+     * @note All objects are in _L7NH::Obj namespace. eg: _L7NH::Obj::Statusword
+     */
+    template<uint16_t Index, uint8_t SubIndex, int DataTypeCode, uint8_t Access, bool PdoMappable, bool Persist>
+    struct ObjEntry
+    {
+        typedef typename ObjDataType<DataTypeCode>::type type;                  ///< C type of object value.
+
+        static constexpr uint16_t index = Index;                                ///< Object index.
+        static constexpr uint8_t subindex = SubIndex;                           ///< Object subindex.
+        static constexpr uint8_t dataType = DataTypeCode;                       ///< DataType code. eg: UINT
+        static constexpr uint8_t size = sizeof(type);                           ///< Byte size of object value.
+        static constexpr uint8_t access = Access;                               ///< Access rights.
+        static constexpr bool pdoMappable = PdoMappable;                        ///< true if object can be mapped in PDO.
+        static constexpr bool persist = Persist;                                ///< true if object is kept in parameter snapshot.
+        static constexpr bool readable = ((Access & Access_RO) != 0);           ///< true if object can be read.
+        static constexpr bool writable = ((Access & Access_WO) != 0);           ///< true if object can be written.
+    };
+
+    /// Object types.
+    namespace Obj
+    {
+        #define L7NH_OBJECT_TYPEDEF(name, index, subindex, dataType, access, pdo, persist) \
+            typedef ObjEntry<index, subindex, dataType, access, pdo, persist> name;
+
+        L7NH_OBJECT_TABLE(L7NH_OBJECT_TYPEDEF)
+
+        #undef L7NH_OBJECT_TYPEDEF
+    }
+
+    /// Runtime object descriptor.
+    struct ObjDescriptor
+    {
+        const char *name;           ///< Object name. Same as type name in _L7NH::Obj namespace.
+        uint16_t index;             ///< Object index.
+        uint8_t subindex;           ///< Object subindex.
+        uint8_t dataType;           ///< DataType code. eg: UINT
+        uint8_t size;               ///< Byte size of object value.
+        uint8_t access;             ///< Access rights.
+        bool pdoMappable;           ///< true if object can be mapped in PDO.
+        bool persist;               ///< true if object is kept in parameter snapshot.
+    };
+
+    /// Descriptor table of all objects in L7NH_OBJECT_TABLE.
+    inline constexpr ObjDescriptor objTable[] =
+    {
+        #define L7NH_OBJECT_DESCRIPTOR(name, index, subindex, dataType, access, pdo, persist) \
+            {#name, index, subindex, dataType, sizeof(ObjDataType<dataType>::type), access, pdo, persist},
+
+        L7NH_OBJECT_TABLE(L7NH_OBJECT_DESCRIPTOR)
+
+        #undef L7NH_OBJECT_DESCRIPTOR
+    };
+
+    /// Number of objects in descriptor table.
+    inline constexpr int objTableSize = sizeof(objTable) / sizeof(objTable[0]);
+
+    /**
+     * @brief Find descriptor of an object.
+     * @return nullptr if object is not in table.
+     */
+    inline const ObjDescriptor* findObject(uint16_t index, uint8_t subindex)
+    {
+        for(int i = 0; i < objTableSize; i++)
+        {
+            if( (objTable[i].index == index) && (objTable[i].subindex == subindex) )
+            {
+                return &objTable[i];
+            }
+        }
+
+        return nullptr;
+    }
+}
+
+#endif
@@ -0,0 +1,487 @@
+#include "ServoDriveLS_L7NH_path.h"
+#include <math.h>                           // sqrt, atan2, llround
+
+L7NHPath::L7NHPath()
+{
+    parameters.PERIOD = 1000000;
+    parameters.MAX_ACCELERATION = 0;
+    parameters.JUNCTION_DEVIATION = 0;
+
+    for(int i = 0; i < L7NH_PATH_MAX_AXES; i++)
+    {
+        _axes[i] = nullptr;
+        _gains[i] = 0;
+        _queuedEnd[i] = 0;
+        _position[i] = 0;
+    }
+
+    _numAxes = 0;
+    _dt = 0;
+    _head = 0;
+    _count = 0;
+    _pending.store(0);
+    _override.store(1.0);
+    _s = 0;
+    _velocity = 0;
+}
+
+bool L7NHPath::addAxis(L7NH *axis)
+{
+    if(axis == nullptr)
+    {
+        errorMessage = "Error L7NHPath: Axis pointer is null.";
+        return false;
+    }
+
+    if(_numAxes >= L7NH_PATH_MAX_AXES)
+    {
+        errorMessage = "Error L7NHPath: Number of axes is more than L7NH_PATH_MAX_AXES.";
+        return false;
+    }
+
+    float gain = axis->getPositionGain();
+
+    if(gain <= 0)
+    {
+        errorMessage = "Error L7NHPath: Position gain of axis is not valid. Use axis init() first.";
+        return false;
+    }
+
+    _axes[_numAxes] = axis;
+    _gains[_numAxes] = gain;
+    _numAxes++;
+
+    return true;
+}
+
+bool L7NHPath::reset(void)
+{
+    if( (parameters.PERIOD == 0) || (parameters.MAX_ACCELERATION <= 0) || (parameters.JUNCTION_DEVIATION < 0) )
+    {
+        errorMessage = "Error L7NHPath: PERIOD and MAX_ACCELERATION must be more than zero and JUNCTION_DEVIATION can not be negative.";
+        return false;
+    }
+
+    _dt = (double)parameters.PERIOD * 1e-9;
+
+    _L7NH::PathSegment segment;
+    while(_queue.pop(segment))
+    {
+    }
+
+    for(int i = 0; i < _numAxes; i++)
+    {
+        _position[i] = (double)_axes[i]->value.posActStep * _gains[i];
+        _queuedEnd[i] = _position[i];
+    }
+
+    _head = 0;
+    _count = 0;
+    _pending.store(0);
+    _s = 0;
+    _velocity = 0;
+
+    return true;
+}
+
+bool L7NHPath::addLine(const float *end, float feed)
+{
+    _L7NH::PathSegment segment;
+
+    segment.type = 0;
+    segment.axisA = 0;
+    segment.axisB = 0;
+    segment.feed = feed;
+
+    return _push(segment, end);
+}
+
+bool L7NHPath::addArc(int axisA, int axisB, const float *end, float centerA, float centerB, bool ccw, float feed)
+{
+    if( (axisA < 0) || (axisA >= _numAxes) || (axisB < 0) || (axisB >= _numAxes) || (axisA == axisB) )
+    {
+        errorMessage = "Error L7NHPath: Arc plane axes are not correct.";
+        return false;
+    }
+
+    _L7NH::PathSegment segment;
+
+    segment.type = 1;
+    segment.axisA = (uint8_t)axisA;
+    segment.axisB = (uint8_t)axisB;
+    segment.feed = feed;
+    segment.center[0] = centerA;
+    segment.center[1] = centerB;
+
+    double startA = _queuedEnd[axisA] - centerA;
+    double startB = _queuedEnd[axisB] - centerB;
+    double endA = (double)end[axisA] - centerA;
+    double endB = (double)end[axisB] - centerB;
+
+    double r0 = sqrt(startA * startA + startB * startB);
+    double r1 = sqrt(endA * endA + endB * endB);
+
+    // Allow rounding error of float end and center.
+    if( (r0 <= 0) || (fabs(r0 - r1) > 1e-4 * (r0 + 1.0)) )
+    {
+        errorMessage = "Error L7NHPath: Arc end point is not on circle of start point.";
+        return false;
+    }
+
+    segment.radius = r0;
+    segment.startAngle = atan2(startB, startA);
+
+    double sweep = atan2(endB, endA) - segment.startAngle;
+
+    if(ccw)
+    {
+        if(sweep <= 0)
+        {
+            sweep += 2.0 * M_PI;
+        }
+    }
+    else
+    {
+        if(sweep >= 0)
+        {
+            sweep -= 2.0 * M_PI;
+        }
+    }
+
+    segment.sweep = sweep;
+
+    return _push(segment, end);
+}
+
+void L7NHPath::setOverride(float ratio)
+{
+    if(ratio < 0)
+    {
+        ratio = 0;
+    }
+
+    _override.store(ratio, std::memory_order_relaxed);
+}
+
+bool L7NHPath::update(void)
+{
+    if( (_numAxes == 0) || (_dt <= 0) )
+    {
+        return false;
+    }
+
+    _fetch();
+
+    double amax = parameters.MAX_ACCELERATION;
+    double dv = amax * _dt;
+    double ratio = _override.load(std::memory_order_relaxed);
+
+    double vdesired = 0;
+
+    if(_count > 0)
+    {
+        vdesired = _segments[_head].feed * ratio;
+
+        // Distance from path position to end of each lookahead segment.
+        double dist = -_s;
+
+        for(int k = 0; k < _count; k++)
+        {
+            int index = (_head + k) % L7NH_PATH_LOOKAHEAD;
+
+            dist += _segments[index].length;
+
+            if(dist < 0)
+            {
+                dist = 0;
+            }
+
+            double vend = 0;
+
+            if(k < _count - 1)
+            {
+                int next = (index + 1) % L7NH_PATH_LOOKAHEAD;
+
+                vend = _junctions[index];
+
+                if(vend > _segments[next].feed * ratio)
+                {
+                    vend = _segments[next].feed * ratio;
+                }
+            }
+
+            // Highest velocity that still reaches vend at this distance with steps of dv per cycle.
+            double vstop = sqrt(vend * vend + 2.0 * amax * dist + 0.25 * dv * dv) - 0.5 * dv;
+
+            if(vstop < vdesired)
+            {
+                vdesired = vstop;
+            }
+
+            // Next constraints are farther than stop distance from vdesired.
+            if(sqrt(2.0 * amax * dist) - dv >= vdesired)
+            {
+                break;
+            }
+        }
+    }
+
+    double change = vdesired - _velocity;
+    if(change > dv)
+    {
+        change = dv;
+    }
+    else if(change < -dv)
+    {
+        change = -dv;
+    }
+
+    _velocity += change;
+    if(_velocity < 0)
+    {
+        _velocity = 0;
+    }
+
+    _s += _velocity * _dt;
+
+    while(_count > 0)
+    {
+        _L7NH::PathSegment &segment = _segments[_head];
+
+        if(_s < segment.length)
+        {
+            _point(segment, _s, _position);
+            break;
+        }
+
+        if(_count == 1)
+        {
+            // End of queue. Stop exactly on the end point.
+            _point(segment, segment.length, _position);
+            _s = 0;
+            _velocity = 0;
+        }
+        else
+        {
+            _s -= segment.length;
+        }
+
+        _head = (_head + 1) % L7NH_PATH_LOOKAHEAD;
+        _count--;
+        _pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool state = true;
+
+    for(int i = 0; i < _numAxes; i++)
+    {
+        state = _axes[i]->setTargetPositionPDO((int32_t)llround(_position[i] / _gains[i])) && state;
+    }
+
+    return state;
+}
+
+bool L7NHPath::isDone(void)
+{
+    return (_pending.load(std::memory_order_acquire) == 0);
+}
+
+int L7NHPath::getSegmentCount(void)
+{
+    return _pending.load(std::memory_order_relaxed);
+}
+
+int L7NHPath::getAxisCount(void)
+{
+    return _numAxes;
+}
+
+double L7NHPath::getPosition(int axis)
+{
+    if( (axis < 0) || (axis >= _numAxes) )
+    {
+        return 0;
+    }
+
+    return _position[axis];
+}
+
+double L7NHPath::getVelocity(void)
+{
+    return _velocity;
+}
+
+void L7NHPath::_fetch(void)
+{
+    _L7NH::PathSegment segment;
+
+    while( (_count < L7NH_PATH_LOOKAHEAD) && _queue.pop(segment) )
+    {
+        int tail = (_head + _count) % L7NH_PATH_LOOKAHEAD;
+
+        _segments[tail] = segment;
+        _junctions[tail] = 0;
+
+        if(_count > 0)
+        {
+            int previous = (tail + L7NH_PATH_LOOKAHEAD - 1) % L7NH_PATH_LOOKAHEAD;
+
+            double in[L7NH_PATH_MAX_AXES];
+            double out[L7NH_PATH_MAX_AXES];
+
+            _tangent(_segments[previous], true, in);
+            _tangent(_segments[tail], false, out);
+
+            double cosine = 0;
+            for(int i = 0; i < _numAxes; i++)
+            {
+                cosine -= in[i] * out[i];
+            }
+
+            // Sine of half angle between reversed incoming and outgoing direction. 1 means straight path.
+            double sine = sqrt(0.5 * (1.0 - cosine));
+            double vmax = (_segments[previous].feed < segment.feed) ? _segments[previous].feed : segment.feed;
+
+            if(sine > 0.999999)
+            {
+                _junctions[previous] = vmax;
+            }
+            else
+            {
+                // Velocity on a circle that is tangent to both directions and deviates JUNCTION_DEVIATION from corner.
+                double v = sqrt(parameters.MAX_ACCELERATION * parameters.JUNCTION_DEVIATION * sine / (1.0 - sine));
+
+                _junctions[previous] = (v < vmax) ? v : vmax;
+            }
+        }
+
+        _count++;
+    }
+}
+
+void L7NHPath::_point(const _L7NH::PathSegment &segment, double s, double *position)
+{
+    double ratio = s / segment.length;
+
+    for(int i = 0; i < _numAxes; i++)
+    {
+        position[i] = segment.start[i] + segment.delta[i] * ratio;
+    }
+
+    if(segment.type == 1)
+    {
+        double angle = segment.startAngle + segment.sweep * ratio;
+
+        position[segment.axisA] = segment.center[0] + segment.radius * cos(angle);
+        position[segment.axisB] = segment.center[1] + segment.radius * sin(angle);
+    }
+}
+
+void L7NHPath::_tangent(const _L7NH::PathSegment &segment, bool end, double *tangent)
+{
+    for(int i = 0; i < _numAxes; i++)
+    {
+        tangent[i] = segment.delta[i] / segment.length;
+    }
+
+    if(segment.type == 1)
+    {
+        double angle = segment.startAngle + (end ? segment.sweep : 0);
+        double speed = segment.radius * segment.sweep / segment.length;
+
+        tangent[segment.axisA] = -speed * sin(angle);
+        tangent[segment.axisB] = speed * cos(angle);
+    }
+}
+
+bool L7NHPath::_push(_L7NH::PathSegment &segment, const float *end)
+{
+    if( (_numAxes == 0) || (end == nullptr) )
+    {
+        errorMessage = "Error L7NHPath: No axis is added or end position is null.";
+        return false;
+    }
+
+    if(_dt <= 0)
+    {
+        errorMessage = "Error L7NHPath: Path is not reset. Use reset() first.";
+        return false;
+    }
+
+    if(segment.feed <= 0)
+    {
+        errorMessage = "Error L7NHPath: Feed must be more than zero.";
+        return false;
+    }
+
+    double sum = 0;
+
+    for(int i = 0; i < L7NH_PATH_MAX_AXES; i++)
+    {
+        if(i < _numAxes)
+        {
+            segment.start[i] = _queuedEnd[i];
+            segment.delta[i] = (double)end[i] - _queuedEnd[i];
+        }
+        else
+        {
+            segment.start[i] = 0;
+            segment.delta[i] = 0;
+        }
+
+        if( (segment.type == 1) && ( (i == segment.axisA) || (i == segment.axisB) ) )
+        {
+            continue;
+        }
+
+        sum += segment.delta[i] * segment.delta[i];
+    }
+
+    if(segment.type == 1)
+    {
+        double arc = segment.radius * segment.sweep;
+
+        sum += arc * arc;
+
+        // Centripetal acceleration v^2/r is limited by MAX_ACCELERATION.
+        double vmax = sqrt(parameters.MAX_ACCELERATION * segment.radius);
+
+        if(segment.feed > vmax)
+        {
+            segment.feed = vmax;
+        }
+    }
+
+    segment.length = sqrt(sum);
+
+    if(segment.length < 1e-9)
+    {
+        errorMessage = "Error L7NHPath: Segment length is zero.";
+        return false;
+    }
+
+    _pending.fetch_add(1, std::memory_order_relaxed);
+
+    if(_queue.push(segment) == false)
+    {
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+        errorMessage = "Error L7NHPath: Segment queue is full.";
+        return false;
+    }
+
+    for(int i = 0; i < _numAxes; i++)
+    {
+        _queuedEnd[i] = end[i];
+    }
+
+    // Next segment starts on the exact end of arc.
+    if(segment.type == 1)
+    {
+        double angle = segment.startAngle + segment.sweep;
+
+        _queuedEnd[segment.axisA] = segment.center[0] + segment.radius * cos(angle);
+        _queuedEnd[segment.axisB] = segment.center[1] + segment.radius * sin(angle);
+    }
+
+    return true;
+}
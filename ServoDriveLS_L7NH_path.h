@@ -0,0 +1,194 @@
+#ifndef L7NH_PATH_H
+#define L7NH_PATH_H
+
+// Header Includes:
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+#include "ServoDriveLS_L7NH_queue.h"        // lock-free queue
+
+// ####################################################
+// Macros:
+
+// Maximum number of axes in one path.
+#define L7NH_PATH_MAX_AXES              8
+
+// Number of preallocated segments between producer and cyclic thread. Must be a power of 2.
+#define L7NH_PATH_QUEUE_SIZE            256
+
+// Number of segments that cyclic thread looks ahead for deceleration.
+#define L7NH_PATH_LOOKAHEAD             32
+
+// ####################################################
+
+namespace _L7NH
+{
+    /// @brief Path segment. Positions are in [deg] of each axis.
+    struct PathSegment
+    {
+        uint8_t type;                               ///< 0: line, 1: arc.
+        uint8_t axisA;                              ///< First axis of arc plane.
+        uint8_t axisB;                              ///< Second axis of arc plane.
+        float feed;                                 ///< Path velocity. [deg/s]
+        double length;                              ///< Path length. [deg]
+        double start[L7NH_PATH_MAX_AXES];           ///< Start position.
+        double delta[L7NH_PATH_MAX_AXES];           ///< end - start. For arc it is used for axes out of plane.
+        double center[2];                           ///< Arc center in plane.
+        double radius;                              ///< Arc radius.
+        double startAngle;                          ///< Arc start angle. [rad]
+        double sweep;                               ///< Arc sweep. Positive is counter clockwise from axisA to axisB. [rad]
+    };
+}
+
+/**
+ * @brief Coordinated multi-axis path planner for cyclic synchronous position mode.
+ * Lines and arcs are queued from a non real-time thread. Each update() advances one path parameter
+ * and writes TargetPosition of all axes in one pass, so every axis gets the setpoint of the same path point
+ * in the same frame.
+ * @note - Path velocity is limited by segment feed * override and MAX_ACCELERATION. The cyclic thread looks ahead
+ * up to L7NH_PATH_LOOKAHEAD segments and decelerates in time for corners and end of queue.
+ * @note - Segments are blended at corners: path passes a junction without stop at a speed
+ * that keeps centripetal acceleration of a JUNCTION_DEVIATION corner radius under MAX_ACCELERATION.
+ * Direction changes in one cycle at the junction, so larger JUNCTION_DEVIATION gives faster corners and larger
+ * velocity steps on axes. Arc feed is limited so centripetal acceleration is under MAX_ACCELERATION.
+ * @note - update() runs in bounded time and never allocates.
+ * @note - User units are [deg] with GEAR_RATIO of axis applied, same as value.posActDeg.
+ */
+class L7NHPath
+{
+public:
+
+    /// @brief Last error message accured for object.
+    std::string errorMessage;
+
+    /// @brief Parameters structure.
+    struct ParameterStructure
+    {
+        /// @brief Cycle period of update(). [ns]
+        uint32_t PERIOD;
+
+        /// @brief Maximum path acceleration and deceleration. [deg/s^2]
+        float MAX_ACCELERATION;
+
+        /// @brief Allowed corner deviation at junction of segments. Zero means full stop at each corner. [deg]
+        float JUNCTION_DEVIATION;
+    }parameters;
+
+    /// @brief Default constructor. Init parameters.
+    L7NHPath();
+
+    /**
+     * @brief Add an axis to path. Axis number is the order of adding.
+     * @return true if successed.
+     * @note Use it after axis init(), so position gain is valid. Then use reset().
+     */
+    bool addAxis(L7NH *axis);
+
+    /**
+     * @brief Clear all segments and set path position at current actual position of axes.
+     * @return false if parameters are not correct.
+     * @note Do not use it while update() is running.
+     */
+    bool reset(void);
+
+    /**
+     * @brief Queue a line from end of previous segment.
+     * @param end is end position of all axes. [deg]
+     * @param feed is path velocity. [deg/s]
+     * @return false if queue is full or parameters are not correct.
+     * @note Call addLine() and addArc() from one thread.
+     */
+    bool addLine(const float *end, float feed);
+
+    /**
+     * @brief Queue an arc in plane of axisA and axisB from end of previous segment. Other axes move linear (helix).
+     * @param end is end position of all axes. [deg]
+     * @param centerA, centerB are arc center position on axisA and axisB. [deg]
+     * @param ccw is true for counter clockwise direction from axisA to axisB.
+     * @param feed is path velocity. [deg/s]
+     * @return false if queue is full or parameters are not correct.
+     * @note End point same as start point means a full circle.
+     */
+    bool addArc(int axisA, int axisB, const float *end, float centerA, float centerB, bool ccw, float feed);
+
+    /**
+     * @brief Set feed rate override. It takes effect with acceleration limit. 0 holds path motion.
+     * @param ratio eg: 1.0 is 100%.
+     */
+    void setOverride(float ratio);
+
+    /**
+     * @brief Advance path by one cycle and write TargetPosition of all axes in PDO mode.
+     * @return false if there is no axis or TargetPosition is not in RxPDO mapping.
+     * @note Call it once per cycle from the cyclic thread. eg: executor cycle callback.
+     */
+    bool update(void);
+
+    /// @brief true if all queued segments are done and path is at rest.
+    bool isDone(void);
+
+    /// @brief Get number of segments that are queued or in motion.
+    int getSegmentCount(void);
+
+    /// @brief Get number of axes.
+    int getAxisCount(void);
+
+    /// @brief Get last commanded position of an axis. [deg] Use it in the cyclic thread.
+    double getPosition(int axis);
+
+    /// @brief Get last commanded path velocity. [deg/s] Use it in the cyclic thread.
+    double getVelocity(void);
+
+private:
+
+    L7NH *_axes[L7NH_PATH_MAX_AXES];
+
+    /// Position gain of axes. [deg/pulse]
+    float _gains[L7NH_PATH_MAX_AXES];
+
+    int _numAxes;
+
+    /// Cycle period. [s]
+    double _dt;
+
+    /// Segments from producer thread.
+    _L7NH::MpmcQueue<_L7NH::PathSegment, L7NH_PATH_QUEUE_SIZE> _queue;
+
+    /// End position of last queued segment. Used by producer thread.
+    double _queuedEnd[L7NH_PATH_MAX_AXES];
+
+    /// Segments in lookahead. Ring buffer of cyclic thread.
+    _L7NH::PathSegment _segments[L7NH_PATH_LOOKAHEAD];
+
+    /// Maximum velocity at end of each segment in lookahead for corner to next segment. [deg/s]
+    double _junctions[L7NH_PATH_LOOKAHEAD];
+
+    int _head;
+
+    int _count;
+
+    /// Number of segments in queue and lookahead.
+    std::atomic<int> _pending;
+
+    std::atomic<float> _override;
+
+    /// Path parameter on head segment. [deg]
+    double _s;
+
+    /// Path velocity. [deg/s]
+    double _velocity;
+
+    double _position[L7NH_PATH_MAX_AXES];
+
+    /// Move segments from queue to lookahead and compute their junction velocity.
+    void _fetch(void);
+
+    /// Position of a path parameter on a segment.
+    void _point(const _L7NH::PathSegment &segment, double s, double *position);
+
+    /// Unit tangent of a segment at its start or end.
+    void _tangent(const _L7NH::PathSegment &segment, bool end, double *tangent);
+
+    /// Check and queue a segment. It sets length and producer end position.
+    bool _push(_L7NH::PathSegment &segment, const float *end);
+};
+
+#endif
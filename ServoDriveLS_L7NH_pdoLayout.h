@@ -0,0 +1,184 @@
+// L7NH Driver compile-time PDO layout Header File:
+
+#ifndef _L7NH_PDOLAYOUT_H
+#define _L7NH_PDOLAYOUT_H
+
+// Header Includes:
+#include <stdint.h>                     // fixed width integer types
+#include <string.h>                     // memcpy for unaligned process image access
+#include "ethercat.h"                   // SOEM EtherCAT functionality
+#include "ServoDriveLS_L7NH_objDict.h"  // Object dictionary for L7NH drivers
+
+// ####################################################
+
+namespace _L7NH
+{
+    /**
+     * @brief C type of a PDO mapping value.
+     * @note Only objects that can be mapped on L7NH have a specialization.
+     * Using any other mapping value in a PdoLayout is a compile error.
+     */
+    template<uint32_t MapValue> struct PdoEntryType;
+
+    // RX PDO objects:
+    template<> struct PdoEntryType<MapValue_ControlWord>                    { typedef uint16_t type; };
+    template<> struct PdoEntryType<MapValue_TargetTorque>                   { typedef int16_t  type; };
+    template<> struct PdoEntryType<MapValue_TargetPosition>                 { typedef int32_t  type; };
+    template<> struct PdoEntryType<MapValue_TargetVelocity>                 { typedef int32_t  type; };
+    template<> struct PdoEntryType<MapValue_DigitalOutput_PhysicalOutputs>  { typedef uint32_t type; };
+    template<> struct PdoEntryType<MapValue_ModesOfOperation>               { typedef int8_t   type; };
+
+    // TX PDO objects:
+    template<> struct PdoEntryType<MapValue_StatusWord>                     { typedef uint16_t type; };
+    template<> struct PdoEntryType<MapValue_TorqueActual>                   { typedef int16_t  type; };
+    template<> struct PdoEntryType<MapValue_TorqueDemand>                   { typedef int16_t  type; };
+    template<> struct PdoEntryType<MapValue_PositionActual>                 { typedef int32_t  type; };
+    template<> struct PdoEntryType<MapValue_PositionActualInternal>         { typedef int32_t  type; };
+    template<> struct PdoEntryType<MapValue_PositionDemand>                 { typedef int32_t  type; };
+    template<> struct PdoEntryType<MapValue_PositionDemandInternal>         { typedef int32_t  type; };
+    template<> struct PdoEntryType<MapValue_VelocityActual>                 { typedef int32_t  type; };
+    template<> struct PdoEntryType<MapValue_VelocityDemand>                 { typedef int32_t  type; };
+    template<> struct PdoEntryType<MapValue_FeedbackSpeed>                  { typedef int16_t  type; };
+    template<> struct PdoEntryType<MapValue_DigitalInput>                   { typedef uint32_t type; };
+    template<> struct PdoEntryType<MapValue_OperationModeDisplay>           { typedef int8_t   type; };
+
+    /**
+     * @brief Compile-time PDO layout.
+     * The entries are packed in the process image in the same order of the template arguments.
+     * Offsets, sizes and presence of objects are all constexpr.
+     * @note Example: PdoLayout<MapValue_StatusWord, MapValue_PositionActual>
+     */
+    template<uint32_t... Entries>
+    struct PdoLayout
+    {
+        static_assert(sizeof...(Entries) >= 1, "PdoLayout needs at least one entry.");
+        static_assert(((8 * sizeof(typename PdoEntryType<Entries>::type) == (Entries & 0xFF)) && ...),
+                      "PdoLayout entry bit length does not match its type.");
+
+    private:
+
+        static constexpr uint16_t _offsetOf(uint32_t entry)
+        {
+            const uint32_t list[] = {Entries...};
+            const uint16_t sizes[] = {(uint16_t)sizeof(typename PdoEntryType<Entries>::type)...};
+            uint16_t off = 0;
+            for(unsigned int i = 0; i < sizeof...(Entries); i++)
+            {
+                if(list[i] == entry)
+                {
+                    return off;
+                }
+                off += sizes[i];
+            }
+            return off;
+        }
+
+    public:
+
+        /// Number of mapping entries.
+        static constexpr uint8_t count = sizeof...(Entries);
+
+        /// Mapping entries values. Same order of the template arguments.
+        static constexpr uint32_t entries[sizeof...(Entries)] = {Entries...};
+
+        /// Total bytes of layout in the process image.
+        static constexpr uint16_t size = (0 + ... + (uint16_t)sizeof(typename PdoEntryType<Entries>::type));
+
+        /// True if the mapping value exist in layout.
+        template<uint32_t E>
+        static constexpr bool contains = ((E == Entries) || ...);
+
+        /// Byte offset of the mapping value in the process image.
+        template<uint32_t E>
+        static constexpr uint16_t offset = _offsetOf(E);
+
+        /**
+         * @brief Read a mapped object from process image.
+         * @param image is the first byte of slave inputs (or outputs) in the process image.
+         */
+        template<uint32_t E>
+        static typename PdoEntryType<E>::type read(const uint8_t *image)
+        {
+            static_assert(contains<E>, "Object is not mapped in this PdoLayout.");
+            typename PdoEntryType<E>::type data;
+            memcpy(&data, image + offset<E>, sizeof(data));
+            return data;
+        }
+
+        /**
+         * @brief Write a mapped object in process image.
+         * @param image is the first byte of slave outputs in the process image.
+         */
+        template<uint32_t E>
+        static void write(uint8_t *image, typename PdoEntryType<E>::type data)
+        {
+            static_assert(contains<E>, "Object is not mapped in this PdoLayout.");
+            memcpy(image + offset<E>, &data, sizeof(data));
+        }
+    };
+
+    /**
+     * @brief Typed access to one slave process image with compile-time RX/TX layouts.
+     * @note Attach it after ethercat configMap(), when the IOmap pointers are valid.
+     * After that, each get/set is one load/store without any check or branch.
+     */
+    template<class RxLayout, class TxLayout>
+    class PdoImage
+    {
+    public:
+
+        PdoImage() : _inputs(nullptr), _outputs(nullptr) {}
+
+        /**
+         * @brief Attach to the process image of a slave.
+         * @return true if successed. false if slave IOmap size is not compatible with layouts.
+         */
+        bool attach(int slaveId)
+        {
+            if( (slaveId < 1) || (ec_slave[slaveId].inputs == nullptr) || (ec_slave[slaveId].outputs == nullptr) )
+            {
+                return false;
+            }
+
+            if( (ec_slave[slaveId].Ibytes < TxLayout::size) || (ec_slave[slaveId].Obytes < RxLayout::size) )
+            {
+                return false;
+            }
+
+            _inputs = ec_slave[slaveId].inputs;
+            _outputs = ec_slave[slaveId].outputs;
+            return true;
+        }
+
+        /// Read a TX PDO object. [Object unit]
+        template<uint32_t E>
+        typename PdoEntryType<E>::type get(void) const
+        {
+            return TxLayout::template read<E>(_inputs);
+        }
+
+        /// Write a RX PDO object. [Object unit]
+        template<uint32_t E>
+        void set(typename PdoEntryType<E>::type data)
+        {
+            RxLayout::template write<E>(_outputs, data);
+        }
+
+        /// Access the process data inputs.
+        const uint8_t* inputs(void) const { return _inputs; }
+
+        /// Access the process data outputs.
+        uint8_t* outputs(void) { return _outputs; }
+
+    private:
+
+        uint8_t *_inputs;
+        uint8_t *_outputs;
+    };
+
+    // PDO layouts for PDOMAP_CONFIG_TYPE = 1
+    typedef PdoLayout<MapValue_ControlWord, MapValue_TargetTorque> PdoLayout_Config1_Rx;
+    typedef PdoLayout<MapValue_StatusWord, MapValue_PositionActual, MapValue_VelocityActual, MapValue_OperationModeDisplay, MapValue_DigitalInput> PdoLayout_Config1_Tx;
+}
+
+#endif
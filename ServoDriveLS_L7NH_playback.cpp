@@ -0,0 +1,506 @@
+#include "ServoDriveLS_L7NH_playback.h"
+#include <sys/mman.h>                       // mmap, madvise
+#include <sys/stat.h>                       // fstat
+#include <fcntl.h>                          // open
+#include <unistd.h>                         // close, sysconf
+#include <string.h>                         // memcpy, strerror
+#include <errno.h>                          // errno
+#include <math.h>                           // llround
+#include <chrono>                           // prefetch thread sleep
+
+L7NHPlayback::L7NHPlayback()
+{
+    parameters.PERIOD = 1000000;
+    parameters.INTERPOLATION = 1;
+    parameters.PREFETCH_BYTES = 8 * 1024 * 1024;
+
+    _map = nullptr;
+    _mapSize = 0;
+    memset(&_header, 0, sizeof(_header));
+    memset(_kinds, 0, sizeof(_kinds));
+
+    for(int i = 0; i < L7NH_PLAYBACK_MAX_CHANNELS; i++)
+    {
+        _axes[i] = nullptr;
+        _values[i] = 0;
+    }
+
+    _dataOffset = 0;
+    _blockBytes = 0;
+    _cursorFrame = 0;
+    _cursorOffset = 0;
+    _windowFrame = 0;
+    _phase = 0;
+    _playing.store(false);
+    _inUpdate.store(false);
+    _done.store(false);
+    _frame.store(0);
+    _readOffset.store(0);
+    _prefetchRunning.store(false);
+}
+
+L7NHPlayback::~L7NHPlayback()
+{
+    close();
+}
+
+bool L7NHPlayback::open(const char *path)
+{
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+
+    if(fd < 0)
+    {
+        errorMessage = std::string("Error L7NHPlayback: File can not be opened. ") + strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+
+    if(fstat(fd, &st) != 0)
+    {
+        errorMessage = std::string("Error L7NHPlayback: File size can not be read. ") + strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+
+    if(size < sizeof(_L7NH::PlaybackFileHeader))
+    {
+        errorMessage = "Error L7NHPlayback: File is smaller than header.";
+        ::close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    // Mapping keeps its own reference to file.
+    ::close(fd);
+
+    if(map == MAP_FAILED)
+    {
+        errorMessage = std::string("Error L7NHPlayback: File can not be mapped. ") + strerror(errno);
+        return false;
+    }
+
+    const uint8_t *data = (const uint8_t*)map;
+    _L7NH::PlaybackFileHeader header;
+
+    memcpy(&header, data, sizeof(header));
+
+    const char *error = nullptr;
+
+    size_t dataOffset = sizeof(header) + (((size_t)header.channelCount + 7) & ~(size_t)7);
+    size_t keyBytes = (size_t)header.channelCount * 4;
+    size_t deltaBytes = (size_t)header.channelCount * 2;
+
+    if(header.magic != L7NH_PLAYBACK_FILE_MAGIC)
+    {
+        error = "Error L7NHPlayback: File is not a playback file.";
+    }
+    else if(header.version != L7NH_PLAYBACK_FILE_VERSION)
+    {
+        error = "Error L7NHPlayback: File version is not supported.";
+    }
+    else if( (header.channelCount == 0) || (header.channelCount > L7NH_PLAYBACK_MAX_CHANNELS) )
+    {
+        error = "Error L7NHPlayback: Number of channels is out of range 1 to L7NH_PLAYBACK_MAX_CHANNELS.";
+    }
+    else if( (header.rate == 0) || (header.blockLength == 0) || (header.frameCount == 0) )
+    {
+        error = "Error L7NHPlayback: Rate, block length and number of frames can not be zero.";
+    }
+    else if( (size < dataOffset) || (header.frameCount > (size - dataOffset) / deltaBytes) )
+    {
+        error = "Error L7NHPlayback: File is smaller than its frames.";
+    }
+    else
+    {
+        // Number of frames is limited by file size above, so these sizes do not overflow.
+        uint64_t blocks = header.frameCount / header.blockLength;
+        uint64_t rest = header.frameCount % header.blockLength;
+        size_t blockBytes = keyBytes + (size_t)(header.blockLength - 1) * deltaBytes;
+        uint64_t needed = dataOffset + blocks * blockBytes;
+
+        if(rest > 0)
+        {
+            needed += keyBytes + (rest - 1) * deltaBytes;
+        }
+
+        if(needed > size)
+        {
+            error = "Error L7NHPlayback: File is smaller than its frames.";
+        }
+
+        for(int i = 0; (error == nullptr) && (i < header.channelCount); i++)
+        {
+            if(data[sizeof(header) + i] > PLAYBACK_CHANNEL_TORQUE)
+            {
+                error = "Error L7NHPlayback: Channel kind is not correct.";
+            }
+        }
+
+        _blockBytes = blockBytes;
+    }
+
+    if(error != nullptr)
+    {
+        errorMessage = error;
+        munmap(map, size);
+        return false;
+    }
+
+    // Memory locked by mlockall(MCL_FUTURE), eg: L7NHExecutor LOCK_MEMORY, would keep every played page in RAM.
+    // Unlock the mapping, so pages behind playback can be dropped. It fails harmlessly if nothing is locked.
+    munlock(map, size);
+
+    // Kernel reads ahead more aggressively and drops pages behind.
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    _map = data;
+    _mapSize = size;
+    _header = header;
+    _dataOffset = dataOffset;
+
+    for(int i = 0; i < L7NH_PLAYBACK_MAX_CHANNELS; i++)
+    {
+        _kinds[i] = (i < header.channelCount) ? data[sizeof(header) + i] : 0;
+        _axes[i] = nullptr;
+        _values[i] = 0;
+    }
+
+    _cursorFrame = 0;
+    _cursorOffset = _dataOffset;
+    _readOffset.store(_dataOffset);
+    _frame.store(0);
+    _done.store(false);
+
+    _prefetchRunning.store(true);
+    _prefetchThread = std::thread(&L7NHPlayback::_prefetchLoop, this);
+
+    return true;
+}
+
+void L7NHPlayback::close(void)
+{
+    _stopAndWait();
+
+    if(_prefetchThread.joinable())
+    {
+        _prefetchRunning.store(false);
+        _prefetchThread.join();
+    }
+
+    if(_map != nullptr)
+    {
+        munmap((void*)_map, _mapSize);
+        _map = nullptr;
+        _mapSize = 0;
+    }
+
+    memset(&_header, 0, sizeof(_header));
+}
+
+bool L7NHPlayback::setAxis(int channel, L7NH *axis)
+{
+    if( (channel < 0) || (channel >= _header.channelCount) )
+    {
+        errorMessage = "Error L7NHPlayback: Channel is out of file channels.";
+        return false;
+    }
+
+    _axes[channel] = axis;
+
+    return true;
+}
+
+bool L7NHPlayback::start(void)
+{
+    if(_map == nullptr)
+    {
+        errorMessage = "Error L7NHPlayback: File is not open.";
+        return false;
+    }
+
+    if(parameters.PERIOD == 0)
+    {
+        errorMessage = "Error L7NHPlayback: PERIOD can not be zero.";
+        return false;
+    }
+
+    _stopAndWait();
+
+    _phase = 0;
+    _windowFrame = 0;
+
+    for(int i = 0; i < 4; i++)
+    {
+        _fillWindow(i, (int64_t)i - 1);
+    }
+
+    _frame.store(0, std::memory_order_relaxed);
+    _done.store(false, std::memory_order_relaxed);
+    _playing.store(true, std::memory_order_release);
+
+    return true;
+}
+
+void L7NHPlayback::stop(void)
+{
+    _playing.store(false);
+}
+
+bool L7NHPlayback::update(void)
+{
+    // Announce use before the check. Pairs with _stopAndWait(): either this call sees _playing false, or
+    // _stopAndWait() sees _inUpdate true and waits.
+    _inUpdate.store(true, std::memory_order_seq_cst);
+
+    if(_playing.load(std::memory_order_seq_cst) == false)
+    {
+        _inUpdate.store(false, std::memory_order_release);
+        return false;
+    }
+
+    uint64_t last = _header.frameCount - 1;
+    uint64_t frame = _phase / 1000000000ULL;
+    double t = (double)(_phase % 1000000000ULL) * 1e-9;
+
+    if(frame >= last)
+    {
+        frame = last;
+        t = 0;
+        _done.store(true, std::memory_order_relaxed);
+    }
+    else
+    {
+        _phase += (uint64_t)parameters.PERIOD * _header.rate;
+    }
+
+    _moveWindow(frame);
+
+    bool state = true;
+
+    for(int i = 0; i < _header.channelCount; i++)
+    {
+        double p1 = _window[1][i];
+        double value = p1;
+
+        if( (parameters.INTERPOLATION != 0) && (t > 0) )
+        {
+            double p0 = _window[0][i];
+            double p2 = _window[2][i];
+            double p3 = _window[3][i];
+
+            // Catmull-Rom spline between p1 and p2.
+            value = p1 + 0.5 * t * ( (p2 - p0) + t * ( (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3) + t * (3.0 * (p1 - p2) + p3 - p0) ) );
+        }
+
+        _values[i] = value;
+
+        if(_axes[i] == nullptr)
+        {
+            continue;
+        }
+
+        switch(_kinds[i])
+        {
+            case PLAYBACK_CHANNEL_POSITION:
+                state = _axes[i]->setTargetPositionPDO((int32_t)llround(value)) && state;
+            break;
+            case PLAYBACK_CHANNEL_VELOCITY:
+                state = _axes[i]->setTargetVelocityPDO((int32_t)llround(value)) && state;
+            break;
+            case PLAYBACK_CHANNEL_TORQUE:
+            {
+                long long torque = llround(value);
+                if(torque > INT16_MAX)
+                {
+                    torque = INT16_MAX;
+                }
+                else if(torque < INT16_MIN)
+                {
+                    torque = INT16_MIN;
+                }
+                state = _axes[i]->setTargetTorquePDO((int16_t)torque) && state;
+            }
+            break;
+        }
+    }
+
+    _frame.store(frame, std::memory_order_relaxed);
+    _readOffset.store(_cursorOffset, std::memory_order_relaxed);
+
+    _inUpdate.store(false, std::memory_order_release);
+
+    return state;
+}
+
+void L7NHPlayback::_stopAndWait(void)
+{
+    _playing.store(false, std::memory_order_seq_cst);
+
+    // An update() that already passed its check finishes in one call.
+    while(_inUpdate.load(std::memory_order_seq_cst))
+    {
+        std::this_thread::yield();
+    }
+}
+
+bool L7NHPlayback::isDone(void)
+{
+    return _done.load(std::memory_order_relaxed);
+}
+
+uint64_t L7NHPlayback::getFrame(void)
+{
+    return _frame.load(std::memory_order_relaxed);
+}
+
+uint64_t L7NHPlayback::getFrameCount(void)
+{
+    return _header.frameCount;
+}
+
+int L7NHPlayback::getChannelCount(void)
+{
+    return _header.channelCount;
+}
+
+double L7NHPlayback::getValue(int channel)
+{
+    if( (channel < 0) || (channel >= _header.channelCount) )
+    {
+        return 0;
+    }
+
+    return _values[channel];
+}
+
+void L7NHPlayback::_decodeNext(void)
+{
+    int num = _header.channelCount;
+    const uint8_t *data = _map + _cursorOffset;
+
+    if( (_cursorFrame % _header.blockLength) == 0)
+    {
+        memcpy(_cursorValues, data, (size_t)num * 4);
+        _cursorOffset += (size_t)num * 4;
+    }
+    else
+    {
+        int16_t delta[L7NH_PLAYBACK_MAX_CHANNELS];
+
+        memcpy(delta, data, (size_t)num * 2);
+
+        for(int i = 0; i < num; i++)
+        {
+            // Wrap around like the writer did, without signed overflow.
+            _cursorValues[i] = (int32_t)((uint32_t)_cursorValues[i] + (uint32_t)(int32_t)delta[i]);
+        }
+
+        _cursorOffset += (size_t)num * 2;
+    }
+
+    _cursorFrame++;
+}
+
+void L7NHPlayback::_fillWindow(int slot, int64_t frame)
+{
+    uint64_t last = _header.frameCount - 1;
+    uint64_t target = (frame < 0) ? 0 : ( ((uint64_t)frame > last) ? last : (uint64_t)frame );
+
+    // Decoder is behind target or too far before it. Seek to key frame of target block.
+    if( (target + 1 < _cursorFrame) || (target >= _cursorFrame + _header.blockLength) )
+    {
+        uint64_t block = target / _header.blockLength;
+
+        _cursorFrame = block * _header.blockLength;
+        _cursorOffset = _dataOffset + block * _blockBytes;
+    }
+
+    while(_cursorFrame <= target)
+    {
+        _decodeNext();
+    }
+
+    memcpy(_window[slot], _cursorValues, sizeof(_cursorValues));
+}
+
+void L7NHPlayback::_moveWindow(uint64_t frame)
+{
+    if(frame == _windowFrame)
+    {
+        return;
+    }
+
+    uint64_t shift = frame - _windowFrame;
+
+    if( (frame > _windowFrame) && (shift < 4) )
+    {
+        for(int i = 0; i < 4 - (int)shift; i++)
+        {
+            memcpy(_window[i], _window[i + shift], sizeof(_window[i]));
+        }
+
+        for(int i = 4 - (int)shift; i < 4; i++)
+        {
+            _fillWindow(i, (int64_t)frame + i - 1);
+        }
+    }
+    else
+    {
+        for(int i = 0; i < 4; i++)
+        {
+            _fillWindow(i, (int64_t)frame + i - 1);
+        }
+    }
+
+    _windowFrame = frame;
+}
+
+void L7NHPlayback::_prefetchLoop(void)
+{
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    // Offset of first page that is not touched yet.
+    size_t touched = 0;
+
+    while(_prefetchRunning.load(std::memory_order_relaxed))
+    {
+        size_t begin = _readOffset.load(std::memory_order_relaxed) & ~(page - 1);
+        size_t end = begin + parameters.PREFETCH_BYTES;
+
+        if(end > _mapSize)
+        {
+            end = _mapSize;
+        }
+
+        // Playback moved back or jumped. Start from read position again.
+        if( (touched < begin) || (touched > end) )
+        {
+            touched = begin;
+        }
+
+        if(touched < end)
+        {
+            size_t from = touched & ~(page - 1);
+
+            madvise((void*)(_map + from), end - from, MADV_WILLNEED);
+
+            // Read one byte of each page so it is mapped before cyclic thread reaches it.
+            volatile uint8_t sink = 0;
+            for(size_t i = touched; i < end; i += page)
+            {
+                sink = sink + _map[i];
+            }
+            (void)sink;
+
+            touched = end;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,220 @@
+#ifndef L7NH_PLAYBACK_H
+#define L7NH_PLAYBACK_H
+
+// Header Includes:
+#include <thread>                           // For prefetch thread
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+
+// ####################################################
+// Macros:
+
+// Maximum number of channels (axes) in one playback file.
+#define L7NH_PLAYBACK_MAX_CHANNELS      16
+
+// Playback file magic number. 'L', '7', 'N', 'P'
+#define L7NH_PLAYBACK_FILE_MAGIC        0x504E374C
+
+// Playback file format version.
+#define L7NH_PLAYBACK_FILE_VERSION      1
+
+// ####################################################
+
+namespace _L7NH
+{
+    /**
+     * @brief Header of playback file. All fields are little endian.
+     * @note File layout:
+     * @note - PlaybackFileHeader
+     * @note - uint8_t channel kind for each channel (PLAYBACK_CHANNEL_...), padded by zero to a multiple of 8 bytes.
+     * @note - Blocks of blockLength frames. First frame of each block is a key frame with one int32_t value per channel.
+     * Next frames are int16_t differences from previous frame, one per channel. The last block can be shorter.
+     * @note blockLength 1 means all frames are absolute int32_t values. Writer must use it if a difference does not fit in int16_t.
+     */
+    struct PlaybackFileHeader
+    {
+        uint32_t magic;             ///< L7NH_PLAYBACK_FILE_MAGIC
+        uint16_t version;           ///< L7NH_PLAYBACK_FILE_VERSION
+        uint16_t channelCount;      ///< Number of channels. 1 to L7NH_PLAYBACK_MAX_CHANNELS.
+        uint32_t rate;              ///< Frame rate. [Hz]
+        uint32_t blockLength;       ///< Frames in each block. >= 1.
+        uint64_t frameCount;        ///< Number of frames.
+    };
+
+    static_assert(sizeof(PlaybackFileHeader) == 24, "PlaybackFileHeader must be packed.");
+}
+
+/**
+ * @brief Streaming setpoint playback from a memory mapped trajectory file.
+ * The file is mapped and never loaded in memory. A background thread touches pages ahead of the playback position,
+ * so the cyclic thread does not wait for disk.
+ * @note - Each channel of file feeds one axis. Channel kind selects TargetPosition, TargetVelocity or TargetTorque.
+ * Values are in drive units of that object. eg: [pulses] for position.
+ * @note - If file rate and bus rate differ, frames are resampled. Between frames the value is held or
+ * interpolated by Catmull-Rom cubic spline.
+ * @note - update() never allocates, locks or makes syscalls.
+ * @note - update() runs on the cyclic thread while open(), close(), start() and the destructor run on another one.
+ * These stop playback and then wait until a running update() returns, before they unmap the file or refill the
+ * decode window. The wait is at most one update() call.
+ * @note - Memory locking: open() unlocks the mapping, so pages behind playback can be dropped. With
+ * L7NHExecutor LOCK_MEMORY, call open() after executor start(). start() locks and reads in full every mapping that
+ * exists at that time, and later mappings are only locked on fault where MCL_ONFAULT is supported. Without it,
+ * mlockall(MCL_FUTURE) reads the whole file at open() or makes it fail against RLIMIT_MEMLOCK.
+ */
+class L7NHPlayback
+{
+public:
+
+    /// @brief Channel kinds.
+    enum ChannelKind
+    {
+        PLAYBACK_CHANNEL_POSITION = 0,
+        PLAYBACK_CHANNEL_VELOCITY,
+        PLAYBACK_CHANNEL_TORQUE
+    };
+
+    /// @brief Last error message accured for object.
+    std::string errorMessage;
+
+    /// @brief Parameters structure.
+    struct ParameterStructure
+    {
+        /// @brief Cycle period of update(). [ns]
+        uint32_t PERIOD;
+
+        /// @brief Cubic interpolation between frames. 0: hold previous frame, 1: Catmull-Rom cubic spline.
+        uint8_t INTERPOLATION;
+
+        /// @brief Bytes of file that prefetch thread keeps ahead of playback position.
+        uint32_t PREFETCH_BYTES;
+    }parameters;
+
+    /// @brief Default constructor. Init parameters.
+    L7NHPlayback();
+
+    /// @brief Destructor. Close file.
+    ~L7NHPlayback();
+
+    /**
+     * @brief Map a playback file and check its header.
+     * @return true if successed.
+     */
+    bool open(const char *path);
+
+    /**
+     * @brief Stop playback and unmap file.
+     * @note It waits for a running update() to return.
+     */
+    void close(void);
+
+    /**
+     * @brief Set axis of a channel. nullptr means channel is not played.
+     * @return false if channel is out of file channels.
+     */
+    bool setAxis(int channel, L7NH *axis);
+
+    /**
+     * @brief Start playback from first frame.
+     * @return false if file is not open.
+     * @note If playback is running, it is stopped and a running update() is waited for before restart.
+     */
+    bool start(void);
+
+    /// @brief Stop playback. Axes keep their last setpoints.
+    void stop(void);
+
+    /**
+     * @brief Advance playback by one cycle and write setpoints of all channels that have an axis.
+     * After the last frame the last values are held and isDone() becomes true.
+     * @return false if playback is not started.
+     * @note Call it once per cycle from the cyclic thread.
+     */
+    bool update(void);
+
+    /// @brief true if playback passed the last frame.
+    bool isDone(void);
+
+    /// @brief Get current frame number of playback.
+    uint64_t getFrame(void);
+
+    /// @brief Get number of frames in file.
+    uint64_t getFrameCount(void);
+
+    /// @brief Get number of channels in file.
+    int getChannelCount(void);
+
+    /**
+     * @brief Get last played value of a channel. It is interpolated if INTERPOLATION is enabled.
+     * @note Use it in the cyclic thread after update().
+     */
+    double getValue(int channel);
+
+private:
+
+    /// Mapped file.
+    const uint8_t *_map;
+    size_t _mapSize;
+
+    _L7NH::PlaybackFileHeader _header;
+
+    uint8_t _kinds[L7NH_PLAYBACK_MAX_CHANNELS];
+
+    L7NH *_axes[L7NH_PLAYBACK_MAX_CHANNELS];
+
+    /// Offset of first block in file.
+    size_t _dataOffset;
+
+    /// Bytes of one complete block.
+    size_t _blockBytes;
+
+    /// Next frame that decoder reads.
+    uint64_t _cursorFrame;
+
+    /// Offset of next frame in file.
+    size_t _cursorOffset;
+
+    /// Values of last decoded frame.
+    int32_t _cursorValues[L7NH_PLAYBACK_MAX_CHANNELS];
+
+    /// Decoded frames _windowFrame - 1 to _windowFrame + 2.
+    int32_t _window[4][L7NH_PLAYBACK_MAX_CHANNELS];
+
+    /// Frame of _window[1].
+    uint64_t _windowFrame;
+
+    /// Playback time in units of [ns * frame rate]. Frame = _phase / 1e9.
+    uint64_t _phase;
+
+    double _values[L7NH_PLAYBACK_MAX_CHANNELS];
+
+    std::atomic<bool> _playing;
+
+    /// true while update() uses the mapping and decode state. close() and start() wait for it.
+    std::atomic<bool> _inUpdate;
+
+    std::atomic<bool> _done;
+
+    std::atomic<uint64_t> _frame;
+
+    /// Offset of file that cyclic thread reads now. Used by prefetch thread.
+    std::atomic<size_t> _readOffset;
+
+    std::thread _prefetchThread;
+
+    std::atomic<bool> _prefetchRunning;
+
+    /// Stop playback and wait until no update() uses the mapping and decode state.
+    void _stopAndWait(void);
+
+    /// Decode next frame in _cursorValues.
+    void _decodeNext(void);
+
+    /// Copy decoded frame of a position in window. Frames out of file are clamped.
+    void _fillWindow(int slot, int64_t frame);
+
+    /// Move window so _window[1] is frame.
+    void _moveWindow(uint64_t frame);
+
+    void _prefetchLoop(void);
+};
+
+#endif
@@ -0,0 +1,148 @@
+// L7NH Driver lock-free queue Header File:
+
+#ifndef _L7NH_QUEUE_H
+#define _L7NH_QUEUE_H
+
+// Header Includes:
+#include <stdint.h>                 // fixed width integer types
+#include <stddef.h>                 // size_t
+#include <atomic>                   // atomic operations
+
+// ####################################################
+
+namespace _L7NH
+{
+    /**
+     * @brief Bounded lock-free multi producer/multi consumer queue.
+     * All cells are preallocated. push() and pop() never allocate, never block and never make syscalls.
+     * @note Capacity must be a power of 2.
+     * @note Each cell has a sequence number. A producer owns a cell when its sequence is equal to enqueue
+     * position and a consumer owns it when sequence is equal to position + 1.
+     */
+    template<typename T, size_t Capacity>
+    class MpmcQueue
+    {
+        static_assert((Capacity >= 2) && ((Capacity & (Capacity - 1)) == 0), "MpmcQueue capacity must be a power of 2.");
+
+    public:
+
+        MpmcQueue()
+        {
+            for(size_t i = 0; i < Capacity; i++)
+            {
+                _buffer[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            _enqueuePos.store(0, std::memory_order_relaxed);
+            _dequeuePos.store(0, std::memory_order_relaxed);
+        }
+
+        MpmcQueue(const MpmcQueue&) = delete;
+        MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+        /**
+         * @brief Push data at end of queue.
+         * @return false if queue is full.
+         */
+        bool push(const T &data)
+        {
+            Cell *cell;
+            size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+
+            for(;;)
+            {
+                cell = &_buffer[pos & (Capacity - 1)];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+                if(dif == 0)
+                {
+                    if(_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if(dif < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = _enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->data = data;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+         * @brief Pop data from front of queue.
+         * @return false if queue is empty.
+         */
+        bool pop(T &data)
+        {
+            Cell *cell;
+            size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+
+            for(;;)
+            {
+                cell = &_buffer[pos & (Capacity - 1)];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+
+                if(dif == 0)
+                {
+                    if(_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if(dif < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = _dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            data = cell->data;
+            cell->sequence.store(pos + Capacity, std::memory_order_release);
+
+            return true;
+        }
+
+        /// Approximate number of items in queue.
+        size_t size(void) const
+        {
+            size_t enqueue = _enqueuePos.load(std::memory_order_relaxed);
+            size_t dequeue = _dequeuePos.load(std::memory_order_relaxed);
+
+            return (enqueue >= dequeue) ? (enqueue - dequeue) : 0;
+        }
+
+        /// Maximum number of items in queue.
+        static constexpr size_t capacity(void)
+        {
+            return Capacity;
+        }
+
+    private:
+
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        alignas(64) Cell _buffer[Capacity];
+        alignas(64) std::atomic<size_t> _enqueuePos;
+        alignas(64) std::atomic<size_t> _dequeuePos;
+    };
+}
+
+#endif
@@ -0,0 +1,335 @@
+#include "ServoDriveLS_L7NH_sdoWorker.h"
+
+// ##################################################################
+// SDO lock:
+
+std::mutex& _L7NH::getSdoMutex(int slave)
+{
+    static std::mutex mutexes[EC_MAXSLAVE];
+
+    if( (slave < 0) || (slave >= EC_MAXSLAVE) )
+    {
+        slave = 0;
+    }
+
+    return mutexes[slave];
+}
+
+// ##################################################################
+// L7NHSdoHandle:
+
+L7NHSdoHandle::L7NHSdoHandle()
+{
+    _worker = nullptr;
+    _slot = -1;
+}
+
+L7NHSdoHandle::~L7NHSdoHandle()
+{
+    release();
+}
+
+bool L7NHSdoHandle::valid(void) const
+{
+    return (_worker != nullptr);
+}
+
+bool L7NHSdoHandle::ready(void) const
+{
+    if(_worker == nullptr)
+    {
+        return false;
+    }
+
+    return (_worker->_requests[_slot].state.load(std::memory_order_acquire) == L7NHSdoWorker::_SLOT_DONE);
+}
+
+bool L7NHSdoHandle::success(void) const
+{
+    if(ready() == false)
+    {
+        return false;
+    }
+
+    return (_worker->_requests[_slot].result.wkc > 0);
+}
+
+bool L7NHSdoHandle::wait(uint32_t timeout_us)
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+
+    while(ready() == false)
+    {
+        if( (_worker == nullptr) || (std::chrono::steady_clock::now() >= deadline) )
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    return true;
+}
+
+const L7NHSdoResult* L7NHSdoHandle::result(void) const
+{
+    if(ready() == false)
+    {
+        return nullptr;
+    }
+
+    return &_worker->_requests[_slot].result;
+}
+
+bool L7NHSdoHandle::cancel(void)
+{
+    if(_worker == nullptr)
+    {
+        return false;
+    }
+
+    uint8_t state = L7NHSdoWorker::_SLOT_QUEUED;
+
+    // Worker returns the slot when it pops the request.
+    if(_worker->_requests[_slot].state.compare_exchange_strong(state, L7NHSdoWorker::_SLOT_CANCELLED, std::memory_order_acq_rel) == false)
+    {
+        return false;
+    }
+
+    _worker = nullptr;
+    _slot = -1;
+
+    return true;
+}
+
+void L7NHSdoHandle::release(void)
+{
+    if(_worker == nullptr)
+    {
+        return;
+    }
+
+    uint8_t state = _worker->_requests[_slot].state.load(std::memory_order_acquire);
+
+    while(true)
+    {
+        // If request is queued or running, worker returns the slot after serving it.
+        if( (state == L7NHSdoWorker::_SLOT_QUEUED) || (state == L7NHSdoWorker::_SLOT_ACTIVE) )
+        {
+            if(_worker->_requests[_slot].state.compare_exchange_weak(state, L7NHSdoWorker::_SLOT_ABANDONED, std::memory_order_acq_rel))
+            {
+                break;
+            }
+        }
+        else
+        {
+            _worker->_releaseSlot(_slot);
+            break;
+        }
+    }
+
+    _worker = nullptr;
+    _slot = -1;
+}
+
+// ##################################################################
+// L7NHSdoWorker:
+
+L7NHSdoWorker::L7NHSdoWorker()
+{
+    parameters.TIMEOUT = EC_TIMEOUTRXM;
+    parameters.IDLE_SLEEP = 200;
+
+    for(int i = 0; i < L7NH_SDOWORKER_MAX_REQUESTS; i++)
+    {
+        _requests[i].state.store(_SLOT_FREE, std::memory_order_relaxed);
+        _requests[i].callback = nullptr;
+        _requests[i].user = nullptr;
+        _requests[i].observer = nullptr;
+        _requests[i].observerUser = nullptr;
+        _requests[i].timeout = 0;
+        _freeQueue.push(i);
+    }
+
+    _running.store(false);
+}
+
+L7NHSdoWorker::~L7NHSdoWorker()
+{
+    stop();
+}
+
+bool L7NHSdoWorker::start(void)
+{
+    if(_running.load() == true)
+    {
+        return true;
+    }
+
+    _running.store(true);
+    _thread = std::thread(&L7NHSdoWorker::_threadLoop, this);
+
+    return true;
+}
+
+void L7NHSdoWorker::stop(void)
+{
+    _running.store(false);
+
+    if(_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+bool L7NHSdoWorker::read(uint16_t slave, uint16_t index, uint8_t subindex, int size, L7NHSdoHandle *handle,
+                         L7NHSdoCallback callback, void *user, L7NHSdoCallback observer, void *observer_user, int timeout)
+{
+    return _submit(slave, index, subindex, false, size, nullptr, handle, callback, user, observer, observer_user, timeout);
+}
+
+bool L7NHSdoWorker::write(uint16_t slave, uint16_t index, uint8_t subindex, int size, const void *data, L7NHSdoHandle *handle,
+                          L7NHSdoCallback callback, void *user, L7NHSdoCallback observer, void *observer_user, int timeout)
+{
+    if(data == nullptr)
+    {
+        return false;
+    }
+
+    return _submit(slave, index, subindex, true, size, data, handle, callback, user, observer, observer_user, timeout);
+}
+
+size_t L7NHSdoWorker::getQueueSize(void)
+{
+    return _requestQueue.size();
+}
+
+bool L7NHSdoWorker::_submit(uint16_t slave, uint16_t index, uint8_t subindex, bool write, int size, const void *data,
+                            L7NHSdoHandle *handle, L7NHSdoCallback callback, void *user,
+                            L7NHSdoCallback observer, void *observer_user, int timeout)
+{
+    if( (size <= 0) || (size > L7NH_SDO_MAX_DATA_BYTES) )
+    {
+        return false;
+    }
+
+    int slot;
+
+    if(_freeQueue.pop(slot) == false)
+    {
+        return false;
+    }
+
+    _Request &request = _requests[slot];
+
+    request.result.slave = slave;
+    request.result.index = index;
+    request.result.subindex = subindex;
+    request.result.write = write;
+    request.result.wkc = 0;
+    request.result.size = size;
+    request.result.latency = 0;
+    memset(request.result.data, 0, sizeof(request.result.data));
+    if(write)
+    {
+        memcpy(request.result.data, data, size);
+    }
+    request.callback = callback;
+    request.user = user;
+    request.observer = observer;
+    request.observerUser = observer_user;
+    request.timeout = (timeout > 0) ? timeout : parameters.TIMEOUT;
+
+    if(handle != nullptr)
+    {
+        handle->release();
+        handle->_worker = this;
+        handle->_slot = slot;
+        request.state.store(_SLOT_QUEUED, std::memory_order_release);
+    }
+    else
+    {
+        request.state.store(_SLOT_AUTO, std::memory_order_release);
+    }
+
+    // Request queue has same capacity as slots, so it is never full here.
+    _requestQueue.push(slot);
+
+    return true;
+}
+
+void L7NHSdoWorker::_serve(int slot)
+{
+    _Request &request = _requests[slot];
+    L7NHSdoResult &result = request.result;
+
+    uint8_t state = _SLOT_QUEUED;
+
+    // From here the handle can not withdraw the request.
+    if(request.state.compare_exchange_strong(state, _SLOT_ACTIVE, std::memory_order_acq_rel) == false)
+    {
+        if(state == _SLOT_CANCELLED)
+        {
+            _releaseSlot(slot);
+            return;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_L7NH::getSdoMutex(result.slave));
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        if(result.write)
+        {
+            result.wkc = ec_SDOwrite(result.slave, result.index, result.subindex, FALSE, result.size, result.data, request.timeout);
+        }
+        else
+        {
+            result.wkc = ec_SDOread(result.slave, result.index, result.subindex, FALSE, &result.size, result.data, request.timeout);
+        }
+
+        result.latency = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    if(request.observer != nullptr)
+    {
+        request.observer(result, request.observerUser);
+    }
+
+    if(request.callback != nullptr)
+    {
+        request.callback(result, request.user);
+    }
+
+    state = _SLOT_ACTIVE;
+
+    if(request.state.compare_exchange_strong(state, _SLOT_DONE, std::memory_order_acq_rel) == false)
+    {
+        // Auto request or handle released before completion.
+        _releaseSlot(slot);
+    }
+}
+
+void L7NHSdoWorker::_releaseSlot(int slot)
+{
+    _requests[slot].state.store(_SLOT_FREE, std::memory_order_release);
+    _freeQueue.push(slot);
+}
+
+void L7NHSdoWorker::_threadLoop(void)
+{
+    int slot;
+
+    while(_running.load(std::memory_order_relaxed))
+    {
+        if(_requestQueue.pop(slot))
+        {
+            _serve(slot);
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(parameters.IDLE_SLEEP));
+        }
+    }
+}
@@ -0,0 +1,233 @@
+#ifndef L7NH_SDOWORKER_H
+#define L7NH_SDOWORKER_H
+
+// Header Includes:
+#include <string.h>                         // memcpy
+#include <atomic>                           // atomic operations
+#include <chrono>                           // For time managements
+#include <thread>                           // For thread programming
+#include <mutex>                            // For per slave SDO lock
+#include "ethercat.h"                       // SOEM EtherCAT functionality
+#include "ServoDriveLS_L7NH_queue.h"        // lock-free queue
+
+// ####################################################
+// Macros:
+
+// Number of preallocated SDO requests of one worker. Must be a power of 2.
+#define L7NH_SDOWORKER_MAX_REQUESTS     64
+
+// Maximum data bytes of one asynchronous SDO request.
+#define L7NH_SDO_MAX_DATA_BYTES         32
+
+// ####################################################
+
+namespace _L7NH
+{
+    /**
+     * @brief Get SDO mutex of a slave. All SDO transfers of one slave must hold it.
+     * @note Transfers of different slaves can run concurrently. Slave id out of range shares mutex 0.
+     */
+    std::mutex& getSdoMutex(int slave);
+}
+
+class L7NHSdoWorker;
+
+/// @brief Result of an asynchronous SDO request.
+struct L7NHSdoResult
+{
+    uint16_t slave;                             ///< Ethercat slave id number.
+    uint16_t index;                             ///< Object index.
+    uint8_t subindex;                           ///< Object subindex.
+    bool write;                                 ///< true for SDO download, false for SDO upload.
+    int wkc;                                    ///< Working counter. <= 0 means not successed.
+    int size;                                   ///< Data bytes. For upload, bytes read from drive.
+    uint32_t latency;                           ///< Transfer time on mailbox thread, without lock wait. [us]
+    uint8_t data[L7NH_SDO_MAX_DATA_BYTES];      ///< Uploaded or downloaded data.
+
+    /// Get data in certain type.
+    template<typename T>
+    T as(void) const
+    {
+        static_assert(sizeof(T) <= L7NH_SDO_MAX_DATA_BYTES, "Type is bigger than SDO data buffer.");
+        T data_out;
+        memcpy(&data_out, data, sizeof(T));
+        return data_out;
+    }
+};
+
+/**
+ * @brief Completion callback of asynchronous SDO request.
+ * @note It runs on mailbox thread. Keep it short and do not block in it.
+ */
+typedef void (*L7NHSdoCallback)(const L7NHSdoResult &result, void *user);
+
+/**
+ * @brief Handle of an asynchronous SDO request.
+ * The request slot is returned to worker by release() or destructor.
+ */
+class L7NHSdoHandle
+{
+public:
+
+    L7NHSdoHandle();
+    ~L7NHSdoHandle();
+
+    L7NHSdoHandle(const L7NHSdoHandle&) = delete;
+    L7NHSdoHandle& operator=(const L7NHSdoHandle&) = delete;
+
+    /// @brief true if handle is attached to a request.
+    bool valid(void) const;
+
+    /// @brief true if request is completed. Never blocks.
+    bool ready(void) const;
+
+    /// @brief true if request is completed and working counter is valid.
+    bool success(void) const;
+
+    /**
+     * @brief Wait for completion of request.
+     * @return true if request completed before timeout.
+     * @warning It blocks. Do not use it in the cyclic thread.
+     */
+    bool wait(uint32_t timeout_us);
+
+    /// @brief Get result of request. nullptr if it is not completed.
+    const L7NHSdoResult* result(void) const;
+
+    /**
+     * @brief Withdraw a request that the worker has not started yet. Handle is detached if successed.
+     * @return true if request is withdrawn and will never be sent. false if it is started or completed;
+     * then handle stays attached and the request completes normally.
+     */
+    bool cancel(void);
+
+    /**
+     * @brief Detach handle from request and return request slot to worker.
+     * @note If request is not completed yet, it is still sent and the slot is returned after completion.
+     */
+    void release(void);
+
+private:
+
+    friend class L7NHSdoWorker;
+
+    L7NHSdoWorker *_worker;
+
+    int _slot;
+};
+
+/**
+ * @brief Mailbox worker thread for asynchronous SDO requests.
+ * Requests are queued by a lock-free queue from any thread and served in order by one dedicated thread,
+ * so SDO latency never delays the cyclic process data exchange.
+ */
+class L7NHSdoWorker
+{
+public:
+
+    /// @brief Parameters structure.
+    struct ParameterStructure
+    {
+        /// @brief Mailbox timeout for each SDO request. [us]
+        int TIMEOUT;
+
+        /// @brief Sleep time of worker thread when request queue is empty. [us]
+        uint32_t IDLE_SLEEP;
+    }parameters;
+
+    /// @brief Default constructor. Init parameters.
+    L7NHSdoWorker();
+
+    /// @brief Destructor. Stop worker thread.
+    ~L7NHSdoWorker();
+
+    /**
+     * @brief Start mailbox thread.
+     * @return true if successed.
+     */
+    bool start(void);
+
+    /**
+     * @brief Stop mailbox thread. Queued requests that are not served stay in queue.
+     */
+    void stop(void);
+
+    /**
+     * @brief Queue an SDO upload request.
+     * @param handle is optional. If it is nullptr, request slot is returned automatically after callback.
+     * @param callback is optional completion callback. It runs on mailbox thread.
+     * @param observer is optional. It runs on mailbox thread before callback. eg: SDO statistics of L7NH.
+     * @param timeout is mailbox timeout of this request. [us] 0 uses parameters.TIMEOUT.
+     * @return true if request queued. false if all request slots are busy or size is not valid.
+     * @note It never blocks.
+     */
+    bool read(uint16_t slave, uint16_t index, uint8_t subindex, int size, L7NHSdoHandle *handle,
+              L7NHSdoCallback callback = nullptr, void *user = nullptr,
+              L7NHSdoCallback observer = nullptr, void *observer_user = nullptr, int timeout = 0);
+
+    /**
+     * @brief Queue an SDO download request.
+     * @param handle is optional. If it is nullptr, request slot is returned automatically after callback.
+     * @param callback is optional completion callback. It runs on mailbox thread.
+     * @param observer is optional. It runs on mailbox thread before callback. eg: SDO statistics of L7NH.
+     * @param timeout is mailbox timeout of this request. [us] 0 uses parameters.TIMEOUT.
+     * @return true if request queued. false if all request slots are busy or size is not valid.
+     * @note It never blocks.
+     * @note Requests are served one after another, so a long timeout delays later requests of all slaves.
+     */
+    bool write(uint16_t slave, uint16_t index, uint8_t subindex, int size, const void *data, L7NHSdoHandle *handle,
+               L7NHSdoCallback callback = nullptr, void *user = nullptr,
+               L7NHSdoCallback observer = nullptr, void *observer_user = nullptr, int timeout = 0);
+
+    /// @brief Get number of requests waiting in queue.
+    size_t getQueueSize(void);
+
+private:
+
+    friend class L7NHSdoHandle;
+
+    // Request slot states.
+    enum
+    {
+        _SLOT_FREE = 0,
+        _SLOT_QUEUED,
+        _SLOT_ACTIVE,           ///< Worker is sending the request of a handle.
+        _SLOT_DONE,
+        _SLOT_ABANDONED,
+        _SLOT_CANCELLED,        ///< Withdrawn before start. Worker returns the slot without transfer.
+        _SLOT_AUTO
+    };
+
+    struct _Request
+    {
+        L7NHSdoResult result;
+        L7NHSdoCallback callback;
+        void *user;
+        L7NHSdoCallback observer;
+        void *observerUser;
+        int timeout;
+        std::atomic<uint8_t> state;
+    };
+
+    _Request _requests[L7NH_SDOWORKER_MAX_REQUESTS];
+
+    _L7NH::MpmcQueue<int, L7NH_SDOWORKER_MAX_REQUESTS> _freeQueue;
+
+    _L7NH::MpmcQueue<int, L7NH_SDOWORKER_MAX_REQUESTS> _requestQueue;
+
+    std::thread _thread;
+
+    std::atomic<bool> _running;
+
+    bool _submit(uint16_t slave, uint16_t index, uint8_t subindex, bool write, int size, const void *data,
+                 L7NHSdoHandle *handle, L7NHSdoCallback callback, void *user,
+                 L7NHSdoCallback observer, void *observer_user, int timeout);
+
+    void _serve(int slot);
+
+    void _releaseSlot(int slot);
+
+    void _threadLoop(void);
+};
+
+#endif
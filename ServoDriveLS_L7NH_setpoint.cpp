@@ -0,0 +1,93 @@
+#include "ServoDriveLS_L7NH_setpoint.h"
+
+L7NHSetpointMailbox::L7NHSetpointMailbox()
+{
+    _axis = nullptr;
+
+    memset(_buffers, 0, sizeof(_buffers));
+
+    _back = 0;
+    _middle.store(1);
+    _front = 2;
+
+    _writing.store(false);
+    _published.store(0);
+    _applied.store(0);
+}
+
+bool L7NHSetpointMailbox::attach(L7NH *axis)
+{
+    if(axis == nullptr)
+    {
+        return false;
+    }
+
+    _axis = axis;
+
+    return true;
+}
+
+bool L7NHSetpointMailbox::publish(const L7NHSetpoint &setpoint)
+{
+    if(_writing.exchange(true, std::memory_order_acquire) == true)
+    {
+        return false;
+    }
+
+    _buffers[_back] = setpoint;
+
+    // Give the filled buffer to reader and take the old middle buffer for next write.
+    uint8_t old = _middle.exchange(_back | _DIRTY, std::memory_order_acq_rel);
+    _back = old & 0x03;
+
+    _published.fetch_add(1, std::memory_order_relaxed);
+
+    _writing.store(false, std::memory_order_release);
+
+    return true;
+}
+
+bool L7NHSetpointMailbox::apply(void)
+{
+    if(_axis == nullptr)
+    {
+        return false;
+    }
+
+    if( (_middle.load(std::memory_order_relaxed) & _DIRTY) == 0 )
+    {
+        return false;
+    }
+
+    uint8_t old = _middle.exchange(_front, std::memory_order_acq_rel);
+    _front = old & 0x03;
+
+    const L7NHSetpoint &setpoint = _buffers[_front];
+
+    if(setpoint.mask & L7NHSetpoint::FIELD_MODE_OF_OPERATION)
+        _axis->setModesOfOperationPDO(setpoint.modeOfOperation);
+    if(setpoint.mask & L7NHSetpoint::FIELD_TARGET_POSITION)
+        _axis->setTargetPositionPDO(setpoint.targetPosition);
+    if(setpoint.mask & L7NHSetpoint::FIELD_TARGET_VELOCITY)
+        _axis->setTargetVelocityPDO(setpoint.targetVelocity);
+    if(setpoint.mask & L7NHSetpoint::FIELD_TARGET_TORQUE)
+        _axis->setTargetTorquePDO(setpoint.targetTorque);
+    if(setpoint.mask & L7NHSetpoint::FIELD_DIGITAL_OUTPUTS)
+        _axis->setDigitalOutputsPDO(setpoint.digitalOutputs);
+    if(setpoint.mask & L7NHSetpoint::FIELD_CONTROLWORD)
+        _axis->setControlWordPDO(setpoint.controlWord);
+
+    _applied.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+uint64_t L7NHSetpointMailbox::getPublishedCount(void)
+{
+    return _published.load(std::memory_order_relaxed);
+}
+
+uint64_t L7NHSetpointMailbox::getAppliedCount(void)
+{
+    return _applied.load(std::memory_order_relaxed);
+}
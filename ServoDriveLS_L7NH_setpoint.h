@@ -0,0 +1,97 @@
+#ifndef L7NH_SETPOINT_H
+#define L7NH_SETPOINT_H
+
+// Header Includes:
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+
+// ####################################################
+
+/// @brief Set of setpoints of one axis that is applied together.
+struct L7NHSetpoint
+{
+    /// @brief Field flags. Only fields with their flag in mask are applied.
+    enum
+    {
+        FIELD_CONTROLWORD       = 0x01,
+        FIELD_TARGET_POSITION   = 0x02,
+        FIELD_TARGET_VELOCITY   = 0x04,
+        FIELD_TARGET_TORQUE     = 0x08,
+        FIELD_MODE_OF_OPERATION = 0x10,
+        FIELD_DIGITAL_OUTPUTS   = 0x20
+    };
+
+    uint8_t mask;                   ///< OR of FIELD_... flags.
+    uint16_t controlWord;           ///< Controlword.
+    int32_t targetPosition;         ///< Target position. [pulses]
+    int32_t targetVelocity;         ///< Target velocity. [pulses/s]
+    int16_t targetTorque;           ///< Target torque. [0.1%]
+    int8_t modeOfOperation;         ///< Modes of operation. eg: OPERATION_MODE_CSP
+    uint32_t digitalOutputs;        ///< Digital outputs physical outputs.
+};
+
+/**
+ * @brief Wait-free setpoint channel from application threads into the cyclic thread of one axis.
+ * It is a triple buffer: publish() never waits for the cyclic thread and apply() always gets the latest
+ * complete setpoint set, so fields of one set are never mixed with fields of another set.
+ * @note - publish() can be called from any thread. If two threads publish at the same moment, one of them gets false.
+ * @note - apply() is called only from the cyclic thread, eg: by L7NHExecutor just before sending process data.
+ * @note - Do not set FIELD_CONTROLWORD if a L7NHStateMachine drives the same axis.
+ */
+class L7NHSetpointMailbox
+{
+public:
+
+    /// @brief Default constructor.
+    L7NHSetpointMailbox();
+
+    /**
+     * @brief Attach mailbox to an axis.
+     * @return true if successed.
+     */
+    bool attach(L7NH *axis);
+
+    /**
+     * @brief Publish a setpoint set. A newer set replaces an older set that is not applied yet.
+     * @return false if another thread is publishing at the same moment.
+     */
+    bool publish(const L7NHSetpoint &setpoint);
+
+    /**
+     * @brief Write the latest published set in the process image of axis, if there is a new one.
+     * @return true if a new set is applied.
+     */
+    bool apply(void);
+
+    /// @brief Get number of published sets.
+    uint64_t getPublishedCount(void);
+
+    /// @brief Get number of applied sets. Published minus applied sets are replaced before apply.
+    uint64_t getAppliedCount(void);
+
+private:
+
+    // New data flag in _middle.
+    static constexpr uint8_t _DIRTY = 0x04;
+
+    L7NH *_axis;
+
+    L7NHSetpoint _buffers[3];
+
+    /// Buffer index of writer. Owned by publish().
+    uint8_t _back;
+
+    /// Buffer index exchanged between writer and reader, with _DIRTY flag.
+    std::atomic<uint8_t> _middle;
+
+    /// Buffer index of reader. Owned by apply().
+    uint8_t _front;
+
+    /// Lock of publish() for concurrent writers. It is only tried, never waited.
+    std::atomic<bool> _writing;
+
+    std::atomic<uint64_t> _published;
+
+    std::atomic<uint64_t> _applied;
+};
+
+#endif
@@ -0,0 +1,290 @@
+#include "ServoDriveLS_L7NH_stateMachine.h"
+
+// Controlword bits that state machine owns. Bits 0 to 3 and fault reset bit 7.
+#define L7NH_CONTROLWORD_STATE_MASK     0x008F
+
+// Fault reset bit of controlword.
+#define L7NH_CONTROLWORD_FAULT_RESET    0x0080
+
+L7NHStateMachine::L7NHStateMachine()
+{
+    parameters.TIMEOUT_CYCLES = 0;
+
+    _axis = nullptr;
+    _pending = {0, false, nullptr, nullptr};
+    _active = {0, false, nullptr, nullptr};
+    _pendingState.store(_PENDING_FREE);
+    _activeValid.store(false);
+    _cycles = 0;
+    _resetEdge = false;
+    _command = Controlword_DisableVoltage;
+    _state.store(STATE_UNKNOWN);
+    _controlWord.store(0);
+}
+
+bool L7NHStateMachine::attach(L7NH *axis)
+{
+    if(axis == nullptr)
+    {
+        return false;
+    }
+
+    if( (axis->_TxMapFlag[0] == 0) || (axis->_RxMapFlag[0] == 0) )
+    {
+        return false;
+    }
+
+    _axis = axis;
+
+    // Keep the command that is already in process image.
+    uint8 *outputs = ec_slave[_axis->parameters.ETHERCAT_ID].outputs;
+
+    if(outputs != nullptr)
+    {
+        uint16_t control_word;
+        memcpy(&control_word, outputs + _axis->RxMapOffset_ControlWord, 2);
+        _command = control_word & (L7NH_CONTROLWORD_STATE_MASK & ~L7NH_CONTROLWORD_FAULT_RESET);
+    }
+
+    return true;
+}
+
+bool L7NHStateMachine::request(State target, L7NHStateCallback callback, void *user)
+{
+    switch(target)
+    {
+        case STATE_SWITCH_ON_DISABLED:
+        case STATE_READY_TO_SWITCH_ON:
+        case STATE_SWITCHED_ON:
+        case STATE_OPERATION_ENABLED:
+        case STATE_QUICK_STOP_ACTIVE:
+            break;
+        default:
+            return false;
+    }
+
+    return _submit(target, false, callback, user);
+}
+
+bool L7NHStateMachine::resetFault(L7NHStateCallback callback, void *user)
+{
+    return _submit(STATE_SWITCH_ON_DISABLED, true, callback, user);
+}
+
+bool L7NHStateMachine::quickStop(L7NHStateCallback callback, void *user)
+{
+    return request(STATE_QUICK_STOP_ACTIVE, callback, user);
+}
+
+bool L7NHStateMachine::update(void)
+{
+    if(_axis == nullptr)
+    {
+        return false;
+    }
+
+    if( (_axis->_rxBound[0] == false) || (_axis->snapshot.size < _axis->TxMapOffset_StatusWord + 2) )
+    {
+        return false;
+    }
+
+    uint16_t status_word;
+    memcpy(&status_word, _axis->snapshot.raw + _axis->TxMapOffset_StatusWord, 2);
+
+    State state = decode(status_word);
+    _state.store(state, std::memory_order_relaxed);
+
+    // Take new request. It replaces the running one.
+    if(_pendingState.load(std::memory_order_acquire) == _PENDING_READY)
+    {
+        if(_activeValid.load(std::memory_order_relaxed))
+        {
+            _complete(EVENT_CANCELED);
+        }
+
+        _active = _pending;
+        _cycles = 0;
+        _resetEdge = false;
+        _activeValid.store(true, std::memory_order_relaxed);
+        _pendingState.store(_PENDING_FREE, std::memory_order_release);
+    }
+
+    if(_activeValid.load(std::memory_order_relaxed))
+    {
+        if(_reached(state))
+        {
+            _complete(EVENT_REACHED);
+        }
+        else if( ((state == STATE_FAULT) || (state == STATE_FAULT_REACTION_ACTIVE)) && (_active.faultReset == false) )
+        {
+            _complete(EVENT_FAILED);
+        }
+        else if( (parameters.TIMEOUT_CYCLES != 0) && (_cycles >= parameters.TIMEOUT_CYCLES) )
+        {
+            _complete(EVENT_FAILED);
+        }
+        else
+        {
+            _command = _nextCommand(state);
+            _cycles++;
+        }
+    }
+
+    // Fault reset bit is not held after its request is finished.
+    if(_activeValid.load(std::memory_order_relaxed) == false)
+    {
+        _command &= ~L7NH_CONTROLWORD_FAULT_RESET;
+    }
+
+    uint16_t control_word;
+    memcpy(&control_word, _axis->_rxPtr[0], 2);
+    control_word = (control_word & ~L7NH_CONTROLWORD_STATE_MASK) | _command;
+    memcpy(_axis->_rxPtr[0], &control_word, 2);
+
+    _controlWord.store(control_word, std::memory_order_relaxed);
+
+    return true;
+}
+
+L7NHStateMachine::State L7NHStateMachine::getState(void)
+{
+    return (State)_state.load(std::memory_order_relaxed);
+}
+
+bool L7NHStateMachine::isBusy(void)
+{
+    return _activeValid.load(std::memory_order_relaxed) || (_pendingState.load(std::memory_order_acquire) != _PENDING_FREE);
+}
+
+uint16_t L7NHStateMachine::getControlWord(void)
+{
+    return _controlWord.load(std::memory_order_relaxed);
+}
+
+L7NHStateMachine::State L7NHStateMachine::decode(uint16_t status_word)
+{
+    // Masks of CiA402 statusword state bits.
+    if( (status_word & 0x004F) == StatusWord_NotReadyToSwitchOn )
+        return STATE_NOT_READY_TO_SWITCH_ON;
+    if( (status_word & 0x004F) == StatusWord_SwitchOnDisabled )
+        return STATE_SWITCH_ON_DISABLED;
+    if( (status_word & 0x006F) == StatusWord_ReadyToSwitchOn )
+        return STATE_READY_TO_SWITCH_ON;
+    if( (status_word & 0x006F) == StatusWord_SwitchedOn )
+        return STATE_SWITCHED_ON;
+    if( (status_word & 0x006F) == StatusWord_OperationEnabled )
+        return STATE_OPERATION_ENABLED;
+    if( (status_word & 0x006F) == StatusWord_QuickStopActive )
+        return STATE_QUICK_STOP_ACTIVE;
+    if( (status_word & 0x004F) == StatusWord_FaultReactionActive )
+        return STATE_FAULT_REACTION_ACTIVE;
+    if( (status_word & 0x004F) == StatusWord_Fault )
+        return STATE_FAULT;
+
+    return STATE_UNKNOWN;
+}
+
+const char* L7NHStateMachine::getStateName(State state)
+{
+    switch(state)
+    {
+        case STATE_NOT_READY_TO_SWITCH_ON:  return "Not ready to switch on";
+        case STATE_SWITCH_ON_DISABLED:      return "Switch on disabled";
+        case STATE_READY_TO_SWITCH_ON:      return "Ready to switch on";
+        case STATE_SWITCHED_ON:             return "Switched on";
+        case STATE_OPERATION_ENABLED:       return "Operation enabled";
+        case STATE_QUICK_STOP_ACTIVE:       return "Quick stop active";
+        case STATE_FAULT_REACTION_ACTIVE:   return "Fault reaction active";
+        case STATE_FAULT:                   return "Fault";
+        default:                            return "Unknown";
+    }
+}
+
+bool L7NHStateMachine::_submit(State target, bool fault_reset, L7NHStateCallback callback, void *user)
+{
+    uint8_t free_state = _PENDING_FREE;
+
+    if(_pendingState.compare_exchange_strong(free_state, _PENDING_WRITING, std::memory_order_acquire) == false)
+    {
+        return false;
+    }
+
+    _pending.target = target;
+    _pending.faultReset = fault_reset;
+    _pending.callback = callback;
+    _pending.user = user;
+
+    _pendingState.store(_PENDING_READY, std::memory_order_release);
+
+    return true;
+}
+
+void L7NHStateMachine::_complete(int event)
+{
+    _activeValid.store(false, std::memory_order_relaxed);
+
+    if(_active.callback != nullptr)
+    {
+        _active.callback(*this, event, _active.user);
+    }
+}
+
+bool L7NHStateMachine::_reached(State state)
+{
+    if(_active.target == STATE_QUICK_STOP_ACTIVE)
+    {
+        // Quick stop from a not enabled state ends in switch on disabled.
+        return (state == STATE_QUICK_STOP_ACTIVE) || (state == STATE_SWITCH_ON_DISABLED);
+    }
+
+    return (state == _active.target);
+}
+
+uint16_t L7NHStateMachine::_nextCommand(State state)
+{
+    uint8_t target = _active.target;
+
+    switch(state)
+    {
+        case STATE_FAULT:
+            if(_active.faultReset == false)
+                return Controlword_DisableVoltage;
+            // Fault reset needs a rising edge of bit 7.
+            if(_resetEdge == false)
+            {
+                _resetEdge = true;
+                return Controlword_DisableVoltage;
+            }
+            return L7NH_CONTROLWORD_FAULT_RESET;
+
+        case STATE_SWITCH_ON_DISABLED:
+            if( (target == STATE_SWITCH_ON_DISABLED) || (target == STATE_QUICK_STOP_ACTIVE) )
+                return Controlword_DisableVoltage;
+            return Controlword_Shutdown;
+
+        case STATE_READY_TO_SWITCH_ON:
+        case STATE_SWITCHED_ON:
+        case STATE_OPERATION_ENABLED:
+            switch(target)
+            {
+                case STATE_SWITCH_ON_DISABLED:  return Controlword_DisableVoltage;
+                case STATE_READY_TO_SWITCH_ON:  return Controlword_Shutdown;
+                case STATE_SWITCHED_ON:         return Controlword_SwitchOn;
+                case STATE_QUICK_STOP_ACTIVE:   return Controlword_QuickStop;
+                default:
+                    // Switch on is needed before enable operation.
+                    if(state == STATE_READY_TO_SWITCH_ON)
+                        return Controlword_SwitchOn;
+                    return Controlword_EnableOperation;
+            }
+
+        case STATE_QUICK_STOP_ACTIVE:
+            if(target == STATE_OPERATION_ENABLED)
+                return Controlword_EnableOperation;
+            return Controlword_DisableVoltage;
+
+        default:
+            // Not ready to switch on, fault reaction active or unknown. Wait for drive.
+            return Controlword_DisableVoltage;
+    }
+}
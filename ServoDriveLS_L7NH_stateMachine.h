@@ -0,0 +1,167 @@
+#ifndef L7NH_STATEMACHINE_H
+#define L7NH_STATEMACHINE_H
+
+// Header Includes:
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+
+// ####################################################
+
+class L7NHStateMachine;
+
+/**
+ * @brief Completion callback of a state machine request.
+ * @param event is L7NHStateMachine::Event value.
+ * @note It runs inside update() on the cyclic thread. Keep it short and do not block in it.
+ */
+typedef void (*L7NHStateCallback)(L7NHStateMachine &machine, int event, void *user);
+
+/**
+ * @brief Non-blocking CiA402 drive state machine of one axis.
+ * update() is called once per cycle after the process data is received and the snapshot is taken.
+ * It decodes the statusword from the axis snapshot and writes the next controlword in the process image,
+ * so a transition never sleeps and never sends extra frames.
+ * @note - Statusword must exist in TxPDO and controlword in RxPDO mapping.
+ * @note - request(), resetFault() and quickStop() are lock-free and can be called from any thread.
+ * The request is taken by the next update(). Only one request can wait for update() at a time.
+ * @note - Only bits 0 to 3 and 7 of controlword are written. Other bits (eg: new setpoint, halt) are kept.
+ */
+class L7NHStateMachine
+{
+public:
+
+    /// @brief CiA402 drive states.
+    enum State
+    {
+        STATE_NOT_READY_TO_SWITCH_ON = 0,
+        STATE_SWITCH_ON_DISABLED,
+        STATE_READY_TO_SWITCH_ON,
+        STATE_SWITCHED_ON,
+        STATE_OPERATION_ENABLED,
+        STATE_QUICK_STOP_ACTIVE,
+        STATE_FAULT_REACTION_ACTIVE,
+        STATE_FAULT,
+        STATE_UNKNOWN                   ///< Statusword is not available yet.
+    };
+
+    /// @brief Completion events of requests.
+    enum Event
+    {
+        EVENT_REACHED = 0,              ///< Target state is reached.
+        EVENT_FAILED,                   ///< Drive went to fault or timeout expired.
+        EVENT_CANCELED                  ///< Replaced by a newer request.
+    };
+
+    /// @brief Parameters structure.
+    struct ParameterStructure
+    {
+        /**
+         * @brief Maximum number of update() cycles for reaching target state. 0 means no timeout.
+         * @note eg: 2000 for 2 seconds at 1 kHz cycle.
+         */
+        uint32_t TIMEOUT_CYCLES;
+    }parameters;
+
+    /// @brief Default constructor. Init parameters.
+    L7NHStateMachine();
+
+    /**
+     * @brief Attach state machine to an axis.
+     * @return true if successed.
+     * @note Use it after the axis PDO mapping is configured.
+     * @note update() runs only after the axis is bound by L7NH::bindPDO(), eg: by L7NHExecutor::start().
+     */
+    bool attach(L7NH *axis);
+
+    /**
+     * @brief Request a target state.
+     * @param target is one of STATE_SWITCH_ON_DISABLED, STATE_READY_TO_SWITCH_ON, STATE_SWITCHED_ON,
+     * STATE_OPERATION_ENABLED or STATE_QUICK_STOP_ACTIVE.
+     * @param callback is optional completion callback.
+     * @return false if target is not acceptable or another request is waiting for update().
+     * @note A request does not leave fault state. Use resetFault() for it.
+     */
+    bool request(State target, L7NHStateCallback callback = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Request fault reset. Completed when drive reaches switch on disabled state.
+     * @note If the fault cause is still active, request fails after TIMEOUT_CYCLES.
+     */
+    bool resetFault(L7NHStateCallback callback = nullptr, void *user = nullptr);
+
+    /// @brief Request quick stop. Same as request(STATE_QUICK_STOP_ACTIVE, ...).
+    bool quickStop(L7NHStateCallback callback = nullptr, void *user = nullptr);
+
+    /**
+     * @brief Run one cycle of state machine. Call it from the cyclic thread between receive and send of process data.
+     * @note The axis snapshot must be taken in this cycle. eg: by axis->updateValuesPDO()
+     * @return false if state machine is not attached or statusword/controlword is not mapped or bound.
+     */
+    bool update(void);
+
+    /// @brief Get last decoded drive state. It is safe to call from any thread.
+    State getState(void);
+
+    /// @brief true if a request is running or waiting for update().
+    bool isBusy(void);
+
+    /// @brief Get controlword written in the last update().
+    uint16_t getControlWord(void);
+
+    /// @brief Decode drive state from statusword.
+    static State decode(uint16_t status_word);
+
+    /// @brief Get name string of a state.
+    static const char* getStateName(State state);
+
+private:
+
+    // Pending request slot states.
+    enum
+    {
+        _PENDING_FREE = 0,
+        _PENDING_WRITING,
+        _PENDING_READY
+    };
+
+    L7NH *_axis;
+
+    /// Pending request written by request() and taken by update().
+    struct _Request
+    {
+        uint8_t target;
+        bool faultReset;
+        L7NHStateCallback callback;
+        void *user;
+    }_pending, _active;
+
+    std::atomic<uint8_t> _pendingState;
+
+    /// true if _active is running.
+    std::atomic<bool> _activeValid;
+
+    /// Number of cycles since _active is started.
+    uint32_t _cycles;
+
+    /// true if the low edge of fault reset bit is written.
+    bool _resetEdge;
+
+    /// Controlword bits 0 to 3 and 7 written in last update().
+    uint16_t _command;
+
+    std::atomic<uint8_t> _state;
+
+    std::atomic<uint16_t> _controlWord;
+
+    bool _submit(State target, bool fault_reset, L7NHStateCallback callback, void *user);
+
+    /// Finish active request and call its callback.
+    void _complete(int event);
+
+    /// true if state is the target state of active request.
+    bool _reached(State state);
+
+    /// Get controlword bits 0 to 3 and 7 for next step from current state to target.
+    uint16_t _nextCommand(State state);
+};
+
+#endif
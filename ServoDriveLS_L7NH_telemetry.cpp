@@ -0,0 +1,69 @@
+#include "ServoDriveLS_L7NH_telemetry.h"
+
+L7NHTelemetry::L7NHTelemetry()
+{
+    _drops.store(0);
+}
+
+bool L7NHTelemetry::push(const L7NHTelemetrySample &sample)
+{
+    if(_queue.push(sample) == false)
+    {
+        _drops.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+bool L7NHTelemetry::push(const L7NH &axis, uint16_t axis_index, uint64_t cycle, int64_t time)
+{
+    L7NHTelemetrySample sample;
+
+    sample.time = time;
+    sample.cycle = cycle;
+    sample.axis = axis_index;
+    sample.statusWord = axis.value.statusWord;
+    sample.position = axis.value.posActStep;
+    sample.velocity = axis.value.velActStep;
+    sample.torque = axis.value.trqActStep;
+    sample.controlMode = (int8_t)axis.value.controlMode;
+    sample.digitalInputs = 0;
+
+    for(int i = 0; i <= 7; i++)
+    {
+        if(axis.value.digitalInputs[i])
+        {
+            sample.digitalInputs |= (1 << i);
+        }
+    }
+
+    return push(sample);
+}
+
+bool L7NHTelemetry::pop(L7NHTelemetrySample &sample)
+{
+    return _queue.pop(sample);
+}
+
+int L7NHTelemetry::drain(L7NHTelemetrySample *samples, int max_num)
+{
+    int num = 0;
+
+    while( (num < max_num) && _queue.pop(samples[num]) )
+    {
+        num++;
+    }
+
+    return num;
+}
+
+size_t L7NHTelemetry::size(void)
+{
+    return _queue.size();
+}
+
+uint64_t L7NHTelemetry::getDropCount(void)
+{
+    return _drops.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,81 @@
+#ifndef L7NH_TELEMETRY_H
+#define L7NH_TELEMETRY_H
+
+// Header Includes:
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+#include "ServoDriveLS_L7NH_queue.h"        // lock-free queue
+
+// ####################################################
+// Macros:
+
+// Number of preallocated samples of telemetry ring. Must be a power of 2.
+#define L7NH_TELEMETRY_CAPACITY         4096
+
+// ####################################################
+
+/// @brief Timestamped feedback sample of one axis in one cycle.
+struct L7NHTelemetrySample
+{
+    int64_t time;                   ///< Sample time. CLOCK_MONOTONIC. [ns]
+    uint64_t cycle;                 ///< Cycle counter.
+    uint16_t axis;                  ///< Axis index given by producer.
+    uint16_t statusWord;            ///< Statusword register value.
+    int32_t position;               ///< Actual position. [pulses]
+    int32_t velocity;               ///< Actual velocity. [pulses/s]
+    int16_t torque;                 ///< Actual torque. [0.1%]
+    uint8_t digitalInputs;          ///< Digital inputs. bit 0 is channel 1.
+    int8_t controlMode;             ///< Operation mode display.
+};
+
+/**
+ * @brief Fixed capacity telemetry ring from the cyclic thread to logging, GUI or analytics threads.
+ * All samples are preallocated. push() never allocates, blocks or makes syscalls.
+ * If ring is full, new samples are dropped and counted, so producer is never slowed by a slow consumer.
+ * @note Any number of producers and consumers are allowed.
+ */
+class L7NHTelemetry
+{
+public:
+
+    /// @brief Default constructor.
+    L7NHTelemetry();
+
+    /**
+     * @brief Push a sample.
+     * @return false if ring is full and sample is dropped.
+     */
+    bool push(const L7NHTelemetrySample &sample);
+
+    /**
+     * @brief Push a sample from values of an axis. Use it after axis->updateValuesPDO().
+     * @param axis_index is stored in sample to identify axis.
+     * @return false if ring is full and sample is dropped.
+     */
+    bool push(const L7NH &axis, uint16_t axis_index, uint64_t cycle, int64_t time);
+
+    /**
+     * @brief Pop oldest sample.
+     * @return false if ring is empty.
+     */
+    bool pop(L7NHTelemetrySample &sample);
+
+    /**
+     * @brief Pop up to max_num oldest samples.
+     * @return number of samples written to samples.
+     */
+    int drain(L7NHTelemetrySample *samples, int max_num);
+
+    /// @brief Get approximate number of samples in ring.
+    size_t size(void);
+
+    /// @brief Get number of dropped samples because ring was full.
+    uint64_t getDropCount(void);
+
+private:
+
+    _L7NH::MpmcQueue<L7NHTelemetrySample, L7NH_TELEMETRY_CAPACITY> _queue;
+
+    std::atomic<uint64_t> _drops;
+};
+
+#endif
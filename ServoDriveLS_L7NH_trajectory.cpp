@@ -0,0 +1,231 @@
+#include "ServoDriveLS_L7NH_trajectory.h"
+#include <math.h>                           // sqrt, llround
+
+L7NHTrajectory::L7NHTrajectory()
+{
+    parameters.PROFILE = PROFILE_TRAPEZOIDAL;
+    parameters.PERIOD = 1000000;
+    parameters.MAX_VELOCITY = 0;
+    parameters.MAX_ACCELERATION = 0;
+    parameters.MAX_JERK = 0;
+
+    _axis = nullptr;
+    _gain = 0;
+    _dt = 0;
+    _target.store(0);
+    _position = 0;
+    _velocity = 0;
+    _filterSum = 0;
+    _filterLength = 1;
+    _filterIndex = 0;
+    _settle = 0;
+    _output = 0;
+    _outputVelocity = 0;
+    _targetSeq.store(0);
+    _doneSeq.store(0);
+}
+
+bool L7NHTrajectory::attach(L7NH *axis)
+{
+    if(axis == nullptr)
+    {
+        return false;
+    }
+
+    _gain = axis->getPositionGain();
+
+    if(_gain <= 0)
+    {
+        return false;
+    }
+
+    _axis = axis;
+
+    return reset(axis->value.posActStep);
+}
+
+bool L7NHTrajectory::reset(int32_t position)
+{
+    if( (parameters.PERIOD == 0) || (parameters.MAX_VELOCITY <= 0) || (parameters.MAX_ACCELERATION <= 0) )
+    {
+        return false;
+    }
+
+    if( (parameters.PROFILE == PROFILE_SCURVE) && (parameters.MAX_JERK <= 0) )
+    {
+        return false;
+    }
+
+    _dt = (double)parameters.PERIOD * 1e-9;
+
+    _filterLength = 1;
+
+    if(parameters.PROFILE == PROFILE_SCURVE)
+    {
+        // Time of acceleration ramp is MAX_ACCELERATION/MAX_JERK.
+        double length = (double)parameters.MAX_ACCELERATION / (double)parameters.MAX_JERK / _dt;
+
+        _filterLength = (int)llround(length);
+
+        if(_filterLength < 1)
+        {
+            _filterLength = 1;
+        }
+        else if(_filterLength > L7NH_TRAJECTORY_MAX_FILTER)
+        {
+            _filterLength = L7NH_TRAJECTORY_MAX_FILTER;
+        }
+    }
+
+    int64_t sample = (int64_t)position << _FRACTION_BITS;
+
+    for(int i = 0; i < _filterLength; i++)
+    {
+        _filter[i] = sample;
+    }
+
+    _filterSum = sample * _filterLength;
+    _filterIndex = 0;
+    _settle = 0;
+
+    _position = position;
+    _velocity = 0;
+    _output = position;
+    _outputVelocity = 0;
+    _target.store(position, std::memory_order_relaxed);
+    _doneSeq.store(_targetSeq.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    return true;
+}
+
+void L7NHTrajectory::setTarget(float position)
+{
+    if(_gain <= 0)
+    {
+        return;
+    }
+
+    _target.store((double)position / _gain, std::memory_order_relaxed);
+    _targetSeq.fetch_add(1, std::memory_order_release);
+}
+
+void L7NHTrajectory::setTargetStep(int32_t position)
+{
+    _target.store(position, std::memory_order_relaxed);
+    _targetSeq.fetch_add(1, std::memory_order_release);
+}
+
+bool L7NHTrajectory::update(void)
+{
+    if( (_axis == nullptr) || (_dt <= 0) )
+    {
+        return false;
+    }
+
+    // Sequence is taken before target, so a target set in the middle of this cycle is never reported done by it.
+    uint32_t seq = _targetSeq.load(std::memory_order_acquire);
+    double target = _target.load(std::memory_order_relaxed);
+
+    _L7NH::rampStep(target, (double)parameters.MAX_VELOCITY / _gain, (double)parameters.MAX_ACCELERATION / _gain, _dt, _position, _velocity);
+
+    double previous = _output;
+
+    if(_filterLength > 1)
+    {
+        int64_t sample = llround(_position * (double)(1 << _FRACTION_BITS));
+
+        _filterSum += sample - _filter[_filterIndex];
+        _filter[_filterIndex] = sample;
+
+        _filterIndex++;
+        if(_filterIndex >= _filterLength)
+        {
+            _filterIndex = 0;
+        }
+
+        _output = (double)_filterSum / (double)_filterLength / (double)(1 << _FRACTION_BITS);
+    }
+    else
+    {
+        _output = _position;
+    }
+
+    _outputVelocity = (_output - previous) / _dt;
+
+    // Trapezoidal stage is at rest on target. Wait for filter to settle.
+    if( (_velocity == 0) && (_position == target) )
+    {
+        if(_settle > 0)
+        {
+            _settle--;
+        }
+        else
+        {
+            _doneSeq.store(seq, std::memory_order_relaxed);
+        }
+    }
+    else
+    {
+        _settle = _filterLength;
+    }
+
+    return _axis->setTargetPositionPDO(getPositionStep());
+}
+
+int32_t L7NHTrajectory::getPositionStep(void)
+{
+    return (int32_t)llround(_output);
+}
+
+float L7NHTrajectory::getPosition(void)
+{
+    return (float)(_output * _gain);
+}
+
+float L7NHTrajectory::getVelocity(void)
+{
+    return (float)(_outputVelocity * _gain);
+}
+
+bool L7NHTrajectory::isDone(void)
+{
+    return (_doneSeq.load(std::memory_order_relaxed) == _targetSeq.load(std::memory_order_relaxed));
+}
+
+void _L7NH::rampStep(double target, double vmax, double amax, double dt, double &position, double &velocity)
+{
+    double dv = amax * dt;
+
+    double error = target - position;
+
+    // Stop exactly on target when it is reachable in this cycle without exceeding acceleration limit.
+    if( (fabs(error) <= dv * dt) && (fabs(error - velocity * dt) <= dv * dt) )
+    {
+        position = target;
+        velocity = 0;
+        return;
+    }
+
+    // Highest speed that still stops on target with steps of dv per cycle:
+    // v = n*dv and remaining distance = dv*dt*n*(n+1)/2.
+    double vstop = 0.5 * (-dv + sqrt(dv * dv + 8.0 * amax * fabs(error)));
+
+    double vdesired = (vstop < vmax) ? vstop : vmax;
+    if(error < 0)
+    {
+        vdesired = -vdesired;
+    }
+
+    double change = vdesired - velocity;
+    if(change > dv)
+    {
+        change = dv;
+    }
+    else if(change < -dv)
+    {
+        change = -dv;
+    }
+
+    velocity += change;
+    position += velocity * dt;
+}
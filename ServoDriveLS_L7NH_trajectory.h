@@ -0,0 +1,166 @@
+#ifndef L7NH_TRAJECTORY_H
+#define L7NH_TRAJECTORY_H
+
+// Header Includes:
+#include "ServoDriveLS_L7NH.h"              // L7NH motor driver
+
+// ####################################################
+// Macros:
+
+// Maximum length of S-curve jerk filter. [cycles] eg: 4096 is 1 s at 4 kHz.
+#define L7NH_TRAJECTORY_MAX_FILTER      4096
+
+// ####################################################
+
+namespace _L7NH
+{
+    /**
+     * @brief One cycle of discrete time-optimal ramp of position to target with velocity and acceleration limits.
+     * Velocity changes at most amax * dt in each cycle and position stops exactly on target.
+     * @param position and velocity are state of ramp. They are updated.
+     * @note Units are free but must agree. eg: [pulses], [pulses/s], [pulses/s^2] and dt in [s].
+     * @note vmax, amax and dt must be more than zero.
+     */
+    void rampStep(double target, double vmax, double amax, double dt, double &position, double &velocity);
+}
+
+/**
+ * @brief Online trajectory generator of one axis for cyclic synchronous position mode.
+ * Each update() advances the profile by one cycle and writes the next TargetPosition in the process image.
+ * Target and velocity/acceleration limits can be changed in the middle of motion.
+ * @note - Trapezoidal stage: time-optimal velocity and acceleration limited tracking of target, computed in closed form each cycle.
+ * @note - S-curve: trapezoidal output passes a moving average filter with length MAX_ACCELERATION/MAX_JERK.
+ * It gives a jerk limited profile with the same end position. The profile is delayed half of filter length.
+ * If target is reversed while accelerating, jerk can reach 2 * MAX_JERK for one filter length.
+ * Cycle quantization of the last deceleration step can add a few percent to jerk at the end of motion.
+ * @note - update() runs in constant time and never allocates, so it can run for many axes in one cycle.
+ * @note - User units are [deg] with GEAR_RATIO of axis applied, same as value.posActDeg.
+ */
+class L7NHTrajectory
+{
+public:
+
+    /// @brief Profile types.
+    enum Profile
+    {
+        PROFILE_TRAPEZOIDAL = 0,
+        PROFILE_SCURVE
+    };
+
+    /// @brief Parameters structure.
+    struct ParameterStructure
+    {
+        /// @brief Profile type. PROFILE_TRAPEZOIDAL or PROFILE_SCURVE. It takes effect at reset().
+        uint8_t PROFILE;
+
+        /// @brief Cycle period of update(). [ns]
+        uint32_t PERIOD;
+
+        /// @brief Maximum velocity. [deg/s]
+        float MAX_VELOCITY;
+
+        /// @brief Maximum acceleration and deceleration. [deg/s^2]
+        float MAX_ACCELERATION;
+
+        /// @brief Maximum jerk for PROFILE_SCURVE. [deg/s^3] It takes effect at reset().
+        float MAX_JERK;
+    }parameters;
+
+    /// @brief Default constructor. Init parameters.
+    L7NHTrajectory();
+
+    /**
+     * @brief Attach to an axis and reset trajectory at current actual position of axis.
+     * @return true if successed.
+     * @note Use it after axis init() and updateValuesPDO(), so position gain and actual position are valid.
+     */
+    bool attach(L7NH *axis);
+
+    /**
+     * @brief Reset trajectory at rest in a position. Target is set to the same position.
+     * @param position is in [pulses].
+     * @return false if parameters are not correct.
+     */
+    bool reset(int32_t position);
+
+    /**
+     * @brief Set target position. It can be called in the middle of motion and from any thread. [deg]
+     */
+    void setTarget(float position);
+
+    /**
+     * @brief Set target position in [pulses]. It can be called in the middle of motion and from any thread.
+     */
+    void setTargetStep(int32_t position);
+
+    /**
+     * @brief Advance profile by one cycle and write TargetPosition of axis in PDO mode.
+     * @return false if not attached or TargetPosition is not in RxPDO mapping.
+     * @note Call it once per cycle from the cyclic thread.
+     */
+    bool update(void);
+
+    /// @brief Get last commanded position. [pulses]
+    int32_t getPositionStep(void);
+
+    /// @brief Get last commanded position. [deg]
+    float getPosition(void);
+
+    /// @brief Get last commanded velocity. [deg/s]
+    float getVelocity(void);
+
+    /// @brief true if commanded position reached the last set target and profile is at rest. It is safe to call from any thread.
+    bool isDone(void);
+
+private:
+
+    // Fraction bits of fixed point position in jerk filter.
+    static constexpr int _FRACTION_BITS = 16;
+
+    L7NH *_axis;
+
+    /// Position gain of axis. [deg/pulse]
+    float _gain;
+
+    /// Cycle period. [s]
+    double _dt;
+
+    /// Target position. [pulses]
+    std::atomic<double> _target;
+
+    /// Trapezoidal stage position. [pulses]
+    double _position;
+
+    /// Trapezoidal stage velocity. [pulses/s]
+    double _velocity;
+
+    /// Jerk filter samples in fixed point. [pulses * 2^_FRACTION_BITS]
+    int64_t _filter[L7NH_TRAJECTORY_MAX_FILTER];
+
+    /// Sum of filter samples.
+    int64_t _filterSum;
+
+    /// Filter length. 1 means no filter.
+    int _filterLength;
+
+    /// Index of oldest sample in filter.
+    int _filterIndex;
+
+    /// Number of cycles until filter output is settled on the last trapezoidal output.
+    int _settle;
+
+    /// Output position. [pulses]
+    double _output;
+
+    /// Output velocity. [pulses/s]
+    double _outputVelocity;
+
+    /// Incremented by each setTarget(). [sequence number]
+    std::atomic<uint32_t> _targetSeq;
+
+    /// _targetSeq of the last target that update() reached and settled on. Only update() and reset() write it.
+    std::atomic<uint32_t> _doneSeq;
+
+};
+
+#endif
@@ -1,12 +1,12 @@
 // For complie:
-// g++ -o main main.cpp ../*.cpp ../../simpleEthercat/simpleEthercat.cpp -lsoem
+// g++ -o main main.cpp ../*.cpp ../../simpleEthercat/simpleEthercat.cpp -lsoem -lpthread
 // ###############################################
 // Header Includes:
 #include <iostream>                                         // standard I/O operations
 #include <thread>                                           // For multi thread programming
 #include <chrono>                                           // system clock functions
 #include "../../simpleEthercat/simpleEthercat.h"        // EtherCAT functionality 
-#include "../L7NH.h"                                           // Motor driver library
+#include "../ServoDriveLS_L7NH_executor.h"                      // Motor driver library and cyclic executor
 #include <cmath>
 
 using namespace std;
@@ -22,11 +22,21 @@ const char port_name[] = "enp2s0";
 // Motor Driver object.
 L7NH motor1;
 
+// Mailbox worker for SDO requests out of the process data loop.
+L7NHSdoWorker sdoWorker;
+
+// CiA402 state machine of motor1.
+L7NHStateMachine stateMachine;
+
+// Real-time cyclic executor.
+L7NHExecutor executor;
+
 // ################################################
 // Declare functions
 
 void loop(void);
 void motorSetup_PRE_OP(void);
+void motorWrite(L7NH &axis, const L7NHCycleInfo &info, void *user);
 
 int expectedWKC;
 // #################################################
@@ -41,7 +51,7 @@ int main(void)
             printf("Slave state are in PRE_OP state.\n");
             printf("%d slaves found and configured.\n",ETHERCAT.getSlaveCount());
             // motor1.autoSetup(2);
-            motor1.setSlaveID(1);
+            motor1.parameters.ETHERCAT_ID = 1;
             if(motor1.setModesOfOperationSDO(OPERATION_MODE_PT) == FALSE)
             {
                 printf("motor operation can not set!\n");
@@ -105,33 +115,71 @@ int main(void)
     return 0;
 }
 
+void motorWrite(L7NH &axis, const L7NHCycleInfo &info, void *user)
+{
+    (void)info;
+    (void)user;
+
+    // Torque is commanded only when drive is enabled.
+    if(stateMachine.getState() == L7NHStateMachine::STATE_OPERATION_ENABLED)
+    {
+        axis.setTargetTorquePDO(50);
+    }
+    else
+    {
+        axis.setTargetTorquePDO(0);
+    }
+}
+
 void loop(void)
 {   
-    motor1.servoOnSDO();
+    motor1.setSdoWorker(&sdoWorker);
+    sdoWorker.start();
+    L7NHSdoHandle torqueHandle;
+
+    stateMachine.parameters.TIMEOUT_CYCLES = 2000;
+    stateMachine.attach(&motor1);
+
+    // 1 kHz cyclic thread on core 1. Process data is exchanged only by executor.
+    executor.parameters.PERIOD = 1000000;
+    executor.parameters.PRIORITY = 80;
+    executor.parameters.CPU = 1;
+    executor.parameters.DC_SYNC = 1;
+    executor.addAxis(&motor1, nullptr, motorWrite);
+    executor.addStateMachine(&stateMachine);
+
+    if(executor.start() == false)
+    {
+        printf("%s\n", executor.errorMessage.c_str());
+        return;
+    }
+
+    stateMachine.request(L7NHStateMachine::STATE_OPERATION_ENABLED);
+
+    int count = 0;
 
-    // Using time point and system_clock
-    std::chrono::time_point<std::chrono::system_clock> start, end;
-    float t = 0;
     while(1)
     {
-        t++;
-        motor1.setControlWordPDO(0x000f);
-        // motor1.setTargetPositionSDO(100000*sin(t/10000));
-        motor1.setTargetTorquePDO(50);
-        start = std::chrono::system_clock::now();
-        bool flag_proccess = ETHERCAT.updateProccess();
-        end = std::chrono::system_clock::now();
-        std::chrono::duration<double> elapsed_seconds = end - start;
-        if(flag_proccess)
+        // Cycle timing of the last 5 seconds.
+        if(++count % 50 == 0)
         {
-            // int32_t pos = motor1.getPositionActualPDO();
-            int16_t pos = motor1.getTargetTorqueSDO();
-            printf("rpm: %d\n", (int)t);
+            executor.dumpTiming(stdout);
+            executor.resetTiming();
         }
-        else
+
+        // SDO read runs on mailbox thread and never blocks cyclic thread.
+        if(torqueHandle.ready())
         {
-            printf("Ethercat update proccess failed!\n");
-        }        
-        // std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            int16_t torque = torqueHandle.result()->as<int16_t>();
+            printf("target torque: %d\n", torque);
+        }
+        if(!torqueHandle.valid() || torqueHandle.ready())
+        {
+            motor1.getTargetTorqueSDOAsync(&torqueHandle);
+        }
+
+        printf("state: %s, cycles: %lu\n", L7NHStateMachine::getStateName(stateMachine.getState()), (unsigned long)executor.getCycleCount());
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
-}
\ No newline at end of file
+}